@@ -0,0 +1,238 @@
+#include "src/main.hxx"
+
+using namespace std;
+
+/**
+ * @struct BenchOptions
+ * @brief Command line options of the benchmark driver.
+ */
+struct BenchOptions {
+    vector<string> mtxFiles;
+    vector<int> rmatScales;
+    vector<int> powerLawSizes;
+    int edgeFactor = 16;
+    int warmup = 2;
+    int repeats = 10;
+    int threads = 0;
+    int deltaSize = 10000;
+    int opCount = 100000;
+    bool perf = false;
+    string policy = "hash";
+    string output;
+};
+
+void printUsage(const char* program) {
+    cout << "Usage: " << program << " [options]\n"
+         << "  --mtx <file>          benchmark a Matrix Market graph (repeatable)\n"
+         << "  --rmat <scale>        benchmark an R-MAT graph with 2^scale vertices (repeatable)\n"
+         << "  --powerlaw <n>        benchmark a power-law graph with n vertices (repeatable)\n"
+         << "  --edge-factor <k>     edges per vertex of synthetic graphs (default 16)\n"
+         << "  --warmup <n>          unmeasured runs per benchmark (default 2)\n"
+         << "  --repeats <n>         measured runs per benchmark (default 10)\n"
+         << "  --threads <n>         threads for parallel kernels, 0 = all (default 0)\n"
+         << "  --delta <n>           changes per generated delta (default 10000)\n"
+         << "  --ops <n>             single-edge operations per run (default 100000)\n"
+         << "  --policy <name>       adjacency storage: hash, sorted, flat or avl (default hash)\n"
+         << "  --perf                collect hardware counters with perf_event_open (single-threaded runs only)\n"
+         << "  --out <file>          write JSON to a file instead of stdout\n"
+         << "Without any graph options, samples/G54.mtx, --rmat 14 and --powerlaw 16384 are used.\n";
+}
+
+bool parseOptions(int argc, char* argv[], BenchOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        auto next = [&]() -> const char* { return i + 1 < argc ? argv[++i] : nullptr; };
+        const char* value = nullptr;
+        if (arg == "--perf") {
+            options.perf = true;
+            continue;
+        }
+        if (arg == "--help" || !(value = next()))
+            return false;
+        if (arg == "--mtx") options.mtxFiles.push_back(value);
+        else if (arg == "--rmat") options.rmatScales.push_back(atoi(value));
+        else if (arg == "--powerlaw") options.powerLawSizes.push_back(atoi(value));
+        else if (arg == "--edge-factor") options.edgeFactor = atoi(value);
+        else if (arg == "--warmup") options.warmup = atoi(value);
+        else if (arg == "--repeats") options.repeats = atoi(value);
+        else if (arg == "--threads") options.threads = atoi(value);
+        else if (arg == "--delta") options.deltaSize = atoi(value);
+        else if (arg == "--ops") options.opCount = atoi(value);
+        else if (arg == "--out") options.output = value;
+        else if (arg == "--policy") options.policy = value;
+        else return false;
+    }
+    if (options.mtxFiles.empty() && options.rmatScales.empty() && options.powerLawSizes.empty()) {
+        options.mtxFiles.push_back("samples/G54.mtx");
+        options.rmatScales.push_back(14);
+        options.powerLawSizes.push_back(16384);
+    }
+    return true;
+}
+
+/**
+ * @brief Runs the graph-level benchmarks on one graph.
+ * @param suite The suite to record results in.
+ * @param graph The graph to benchmark; it is restored after every mutating run.
+ * @param options The command line options.
+ */
+template <typename A>
+void benchmarkGraph(BenchmarkSuite& suite, DiGraph<int, int, A>& graph, const BenchOptions& options) {
+    ThreadPool pool(options.threads);
+    int n = graph.getSpan();
+    volatile long long sink = 0;
+
+    // Serial benchmarks run on the calling thread; parallel ones use options.threads.
+    suite.setThreads(1);
+    GraphDelta<int, int> ops(DEFAULT_SEED, options.threads);
+    ops.generateMixedDelta(graph, 1.0, options.opCount, true);
+    suite.run("addEdge", ops.insertions.size(), [&]() {
+        for (const auto& edge : ops.insertions)
+            graph.addEdge(edge.first, edge.second);
+    }, [&]() {
+        graph.removeEdges(ops.insertions, pool);
+    });
+    graph.addEdges(ops.insertions, ops.insertionData, pool);
+    suite.run("removeEdge", ops.insertions.size(), [&]() {
+        for (const auto& edge : ops.insertions)
+            graph.removeEdge(edge.first, edge.second);
+    }, [&]() {
+        graph.addEdges(ops.insertions, ops.insertionData, pool);
+    });
+    graph.removeEdges(ops.insertions, pool);
+
+    suite.run("getInDegree", n, [&]() {
+        long long total = 0;
+        for (int u = 0; u < n; ++u)
+            total += graph.getInDegree(u);
+        sink = sink + total;
+    });
+    suite.run("getOutEdges", n, [&]() {
+        long long total = 0;
+        for (int u = 0; u < n; ++u)
+            total += graph.getOutEdges(u).size();
+        sink = sink + total;
+    });
+
+    CSRView<int, int> csr(graph, true);
+    suite.run("csr.build", graph.getSize(), [&]() { csr.build(graph, true); });
+    suite.run("csr.getOutEdges", n, [&]() {
+        long long total = 0;
+        for (int u = 0; u < n; ++u)
+            total += csr.getOutEdges(u).size();
+        sink = sink + total;
+    });
+
+    int start = 0;
+    for (int u = 0; u < n; ++u) {
+        if (graph.getOutDegree(u) > graph.getOutDegree(start))
+            start = u;
+    }
+    suite.run("bfs", graph.getSize(), [&]() { sink = sink + breadthFirstSearch(graph, start).size(); });
+    suite.run("bfs.csr", graph.getSize(), [&]() { sink = sink + breadthFirstSearch(csr, start).size(); });
+    suite.setThreads(options.threads);
+    suite.run("bfs.parallel", graph.getSize(), [&]() { sink = sink + parallelBreadthFirstSearch(csr, start, pool).order.size(); });
+
+    int count = options.deltaSize;
+    GraphDelta<int, int> delta(DEFAULT_SEED, options.threads);
+    suite.run("generateMixedDelta", count, [&]() { delta.generateMixedDelta(graph, 0.5, count, true); });
+    suite.run("generatePreferentialAttachmentDelta", count, [&]() {
+        delta.generatePreferentialAttachmentDelta(graph, count, 0, 1, 0, true, true);
+    });
+    suite.run("generatePreferentialDetachmentDelta", count, [&]() {
+        delta.generatePreferentialDetachmentDelta(graph, count, 0, 1, 0, true, true);
+    });
+    suite.run("generatePreferentialMixedDelta", count, [&]() {
+        delta.generatePreferentialMixedDelta(graph, count, 0, 1, 0, true, true, 0.5);
+    });
+
+    // Both apply methods have the same effect, so the inverse recorded once restores either.
+    delta.generateMixedDelta(graph, 0.5, count, true);
+    GraphDelta<int, int> inverse;
+    delta.applyBatch(graph, pool, &inverse);
+    inverse.applyBatch(graph, pool);
+    suite.setThreads(1);
+    suite.run("applyCurrentDelta", count, [&]() {
+        delta.applyCurrentDelta(graph);
+    }, [&]() {
+        inverse.applyBatch(graph, pool);
+    });
+    suite.setThreads(options.threads);
+    suite.run("applyBatch", count, [&]() {
+        delta.applyBatch(graph, pool, &inverse);
+    }, [&]() {
+        inverse.applyBatch(graph, pool);
+    });
+
+    // Only the repair of the BFS tree is measured; the graph already has the delta applied.
+    IncrementalBFS<DiGraph<int, int, A>> incremental(graph, {start});
+    delta.applyBatch(graph, pool, &inverse);
+    suite.run("bfs.incremental", count, [&]() {
+        incremental.update(delta, pool);
+    }, [&]() {
+        inverse.applyBatch(graph, pool);
+        incremental.update(inverse, pool);
+        delta.applyBatch(graph, pool, &inverse);
+    });
+    inverse.applyBatch(graph, pool);
+}
+
+/**
+ * @brief Runs all benchmarks on graphs stored with one adjacency policy.
+ * @param suite The suite to record results in.
+ * @param options The command line options.
+ */
+template <typename A>
+void benchmarkAll(BenchmarkSuite& suite, const BenchOptions& options) {
+    string suffix = " [" + options.policy + "]";
+    for (const auto& file : options.mtxFiles) {
+        suite.setGraph(file + suffix);
+        suite.setThreads(options.threads);
+        DiGraph<int, int, A> graph;
+        suite.run("load", 1, [&]() { graph = loadMtxGraphFromFile<int, int, A>(file, options.threads); });
+        cerr << file << ": " << graph.getOrder() << " vertices, " << graph.getSize() << " edges" << endl;
+        benchmarkGraph(suite, graph, options);
+    }
+    for (int scale : options.rmatScales) {
+        auto graph = generateRmatGraph<A>(scale, options.edgeFactor, 0.57, 0.19, 0.19, DEFAULT_SEED, options.threads);
+        suite.setGraph("rmat-" + to_string(scale) + "-" + to_string(options.edgeFactor) + suffix);
+        cerr << "rmat " << scale << ": " << graph.getOrder() << " vertices, " << graph.getSize() << " edges" << endl;
+        benchmarkGraph(suite, graph, options);
+    }
+    for (int size : options.powerLawSizes) {
+        auto graph = generatePowerLawGraph<A>(size, static_cast<long long>(size) * options.edgeFactor, 2.1, DEFAULT_SEED, options.threads);
+        suite.setGraph("powerlaw-" + to_string(size) + "-" + to_string(options.edgeFactor) + suffix);
+        cerr << "powerlaw " << size << ": " << graph.getOrder() << " vertices, " << graph.getSize() << " edges" << endl;
+        benchmarkGraph(suite, graph, options);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    BenchmarkSuite suite(options.warmup, options.repeats, options.perf);
+
+    if (options.policy == "hash")
+        benchmarkAll<HashPolicy>(suite, options);
+    else if (options.policy == "sorted")
+        benchmarkAll<SortedVectorPolicy>(suite, options);
+    else if (options.policy == "flat")
+        benchmarkAll<FlatHashPolicy>(suite, options);
+    else if (options.policy == "avl")
+        benchmarkAll<AVLPolicy>(suite, options);
+    else {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    if (options.output.empty()) {
+        suite.writeJson(cout);
+    } else {
+        ofstream out(options.output);
+        suite.writeJson(out);
+    }
+    return 0;
+}
@@ -1,234 +1,270 @@
 #pragma once
+#include <cstddef>
 #include <vector>
 #include <utility>
 
-template <typename E>
-class AVLTree {
-private:
-    struct Node {
-        int key;
-        E data;
-        int left, right;
-        int height;
+/**
+ * @class AVLTree
+ * @brief An ordered map from non-negative integer keys to values, stored as an AVL tree in an arena.
+ * Nodes live in a vector and refer to each other by index. Erased nodes go on a free list and
+ * are reused by later insertions, so indices stay stable and the arena never shifts.
+ * @tparam T The type of value stored with each key.
+ */
+template <typename T>
+class AVLTree
+{
+    private:
+        struct Node {
+            int key;
+            int left, right;
+            int height;
+            T data;
+        };
+
+        std::vector<Node> nodes;
+        int root = -1;
+        int freeHead = -1;
+        size_t count = 0;
+
+        int height(int index) const {
+            return index == -1 ? 0 : nodes[index].height;
+        }
 
-        Node(int k, const E& d) : key(k), data(d), left(-1), right(-1), height(1) {}
-    };
+        int getBalanceFactor(int index) const {
+            return height(nodes[index].right) - height(nodes[index].left);
+        }
 
-    std::vector<Node> nodes;
+        void fixHeight(int index) {
+            int leftHeight = height(nodes[index].left);
+            int rightHeight = height(nodes[index].right);
+            nodes[index].height = (leftHeight > rightHeight ? leftHeight : rightHeight) + 1;
+        }
 
-    int height(int index) {
-        return (index == -1) ? 0 : nodes[index].height;
-    }
+        int rotateRight(int y) {
+            int x = nodes[y].left;
+            nodes[y].left = nodes[x].right;
+            nodes[x].right = y;
+            fixHeight(y);
+            fixHeight(x);
+            return x;
+        }
 
-    int getBalanceFactor(int index) {
-        return height(nodes[index].right) - height(nodes[index].left);
-    }
+        int rotateLeft(int x) {
+            int y = nodes[x].right;
+            nodes[x].right = nodes[y].left;
+            nodes[y].left = x;
+            fixHeight(x);
+            fixHeight(y);
+            return y;
+        }
 
-    void fixHeight(int index) {
-        int leftHeight = height(nodes[index].left);
-        int rightHeight = height(nodes[index].right);
-        nodes[index].height = (leftHeight > rightHeight ? leftHeight : rightHeight) + 1;
-    }
+        int balance(int index) {
+            fixHeight(index);
+            if (getBalanceFactor(index) == 2) {
+                if (getBalanceFactor(nodes[index].right) < 0)
+                    nodes[index].right = rotateRight(nodes[index].right);
+                return rotateLeft(index);
+            }
+            if (getBalanceFactor(index) == -2) {
+                if (getBalanceFactor(nodes[index].left) > 0)
+                    nodes[index].left = rotateLeft(nodes[index].left);
+                return rotateRight(index);
+            }
+            return index;
+        }
 
-    int rotateRight(int y) {
-        int x = nodes[y].left;
-        nodes[y].left = nodes[x].right;
-        nodes[x].right = y;
-        fixHeight(y);
-        fixHeight(x);
-        return x;
-    }
+        /**
+         * @brief Take a node from the free list, or append one to the arena.
+         */
+        int allocate(int key, const T& data) {
+            int index = freeHead;
+            if (index == -1) {
+                index = nodes.size();
+                nodes.push_back(Node{key, -1, -1, 1, data});
+            } else {
+                freeHead = nodes[index].left;
+                nodes[index] = Node{key, -1, -1, 1, data};
+            }
+            return index;
+        }
 
-    int rotateLeft(int x) {
-        int y = nodes[x].right;
-        nodes[x].right = nodes[y].left;
-        nodes[y].left = x;
-        fixHeight(x);
-        fixHeight(y);
-        return y;
-    }
-
-    int balance(int index) {
-        fixHeight(index);
-
-        if (getBalanceFactor(index) == 2) {
-            if (getBalanceFactor(nodes[index].right) < 0)
-                nodes[index].right = rotateRight(nodes[index].right);
-            return rotateLeft(index);
-        }
-
-        if (getBalanceFactor(index) == -2) {
-            if (getBalanceFactor(nodes[index].left) > 0)
-                nodes[index].left = rotateLeft(nodes[index].left);
-            return rotateRight(index);
-        }
-
-        return index;
-    }
-
-    int insert(int index, int key, const E& data) {
-        if (index == -1) {
-            nodes.push_back(Node(key, data));
-            return nodes.size() - 1;
-        }
-
-        if (key < nodes[index].key)
-            nodes[index].left = insert(nodes[index].left, key, data);
-        else
-            nodes[index].right = insert(nodes[index].right, key, data);
-
-        return balance(index);
-    }
-
-    int remove(int index, int key) {
-        if (index == -1) return -1;
-
-        if (key < nodes[index].key)
-            nodes[index].left = remove(nodes[index].left, key);
-        else if (key > nodes[index].key)
-            nodes[index].right = remove(nodes[index].right, key);
-        else {
-            int l = nodes[index].left;
-            int r = nodes[index].right;
-
-            nodes.erase(nodes.begin() + index);
-
-            if (r == -1) return l;
-
-            int min = findMin(r);
-            nodes[min].right = removeMin(r);
-            nodes[min].left = l;
-
-            return balance(min);
-        }
-
-        return balance(index);
-    }
-
-    int findMin(int index) {
-        return (nodes[index].left == -1) ? index : findMin(nodes[index].left);
-    }
-
-    int removeMin(int index) {
-        if (nodes[index].left == -1) return nodes[index].right;
-
-        nodes[index].left = removeMin(nodes[index].left);
-        return balance(index);
-    }
-
-public:
-    AVLTree() = default;
-
-    void clear() {
-        nodes.clear();
-    }
-
-    bool has(int key) const {
-        if (nodes.size() == 0){
-            return false;
-        }
-        int curr = 0;
-        while (curr != -1) {
-            if (key < nodes[curr].key)
-                curr = nodes[curr].left;
-            else if (key > nodes[curr].key)
-                curr = nodes[curr].right;
-            else
-                return true;
-        }
-        return false;
-    }
-
-    E getValue(int key) const {
-        int curr = 0;
-        while (curr != -1) {
-            if (key < nodes[curr].key)
-                curr = nodes[curr].left;
-            else if (key > nodes[curr].key)
-                curr = nodes[curr].right;
-            else
-                return nodes[curr].data;
+        /**
+         * @brief Put a node on the free list.
+         */
+        void release(int index) {
+            nodes[index].data = T();
+            nodes[index].left = freeHead;
+            freeHead = index;
         }
-        return E();
-    }
-
-    void setValue(int key, E value) {
-        int curr = 0;
-        while (curr != -1) {
-            if (key < nodes[curr].key)
-                curr = nodes[curr].left;
-            else if (key > nodes[curr].key)
-                curr = nodes[curr].right;
-            else
-            {
-                nodes[curr].data = value;
-                break;
+
+        int insert(int index, int key, const T& data, bool& inserted) {
+            if (index == -1) {
+                inserted = true;
+                return allocate(key, data);
+            }
+            if (key < nodes[index].key) {
+                int child = insert(nodes[index].left, key, data, inserted);
+                nodes[index].left = child;
+            } else if (key > nodes[index].key) {
+                int child = insert(nodes[index].right, key, data, inserted);
+                nodes[index].right = child;
+            } else {
+                return index;
             }
+            return inserted ? balance(index) : index;
+        }
+
+        int findMin(int index) const {
+            while (nodes[index].left != -1)
+                index = nodes[index].left;
+            return index;
+        }
+
+        int removeMin(int index) {
+            if (nodes[index].left == -1)
+                return nodes[index].right;
+            nodes[index].left = removeMin(nodes[index].left);
+            return balance(index);
+        }
+
+        int remove(int index, int key, T* value, bool& removed) {
+            if (index == -1)
+                return -1;
+            if (key < nodes[index].key) {
+                nodes[index].left = remove(nodes[index].left, key, value, removed);
+            } else if (key > nodes[index].key) {
+                nodes[index].right = remove(nodes[index].right, key, value, removed);
+            } else {
+                int l = nodes[index].left;
+                int r = nodes[index].right;
+                if (value)
+                    *value = nodes[index].data;
+                release(index);
+                removed = true;
+                if (r == -1)
+                    return l;
+                int min = findMin(r);
+                nodes[min].right = removeMin(r);
+                nodes[min].left = l;
+                return balance(min);
+            }
+            return removed ? balance(index) : index;
+        }
+
+        int locate(int key) const {
+            int curr = root;
+            while (curr != -1 && nodes[curr].key != key)
+                curr = key < nodes[curr].key ? nodes[curr].left : nodes[curr].right;
+            return curr;
+        }
+
+        template <typename Function>
+        void forEachHelper(int index, Function& fn) const {
+            if (index == -1)
+                return;
+            forEachHelper(nodes[index].left, fn);
+            fn(nodes[index].key, nodes[index].data);
+            forEachHelper(nodes[index].right, fn);
+        }
+
+    public:
+        /**
+         * @brief Get the number of keys in the tree.
+         */
+        size_t size() const {
+            return count;
+        }
+
+        /**
+         * @brief Check if the tree has no keys.
+         */
+        bool empty() const {
+            return count == 0;
+        }
+
+        /**
+         * @brief Remove all keys and release the arena's contents.
+         */
+        void clear() {
+            nodes.clear();
+            root = freeHead = -1;
+            count = 0;
+        }
+
+        /**
+         * @brief Reserve arena space for a number of keys.
+         * @param n The number of keys.
+         */
+        void reserve(size_t n) {
+            nodes.reserve(n);
+        }
+
+        /**
+         * @brief Check if a key is in the tree.
+         * @param key The key.
+         */
+        bool contains(int key) const {
+            return locate(key) != -1;
+        }
+
+        /**
+         * @brief Find the value stored with a key.
+         * @param key The key.
+         * @return A pointer to the value, or nullptr if the key is absent.
+         */
+        const T* find(int key) const {
+            int index = locate(key);
+            return index == -1 ? nullptr : &nodes[index].data;
+        }
+
+        T* find(int key) {
+            int index = locate(key);
+            return index == -1 ? nullptr : &nodes[index].data;
+        }
+
+        /**
+         * @brief Insert a key with a value if the key is absent.
+         * @param key The key.
+         * @param value The value.
+         * @return True if the key was inserted, false if it was already present.
+         */
+        bool insert(int key, const T& value = T()) {
+            bool inserted = false;
+            root = insert(root, key, value, inserted);
+            count += inserted;
+            return inserted;
+        }
+
+        /**
+         * @brief Erase a key.
+         * @param key The key.
+         * @param value If non-null and the key was present, set to its value.
+         * @return True if the key was erased, false if it was absent.
+         */
+        bool erase(int key, T* value = nullptr) {
+            bool removed = false;
+            root = remove(root, key, value, removed);
+            count -= removed;
+            if (count == 0)
+                clear();
+            return removed;
+        }
+
+        /**
+         * @brief Call a function for every key and value, in ascending key order.
+         * @param fn The function to call as fn(key, value).
+         */
+        template <typename Function>
+        void forEach(Function&& fn) const {
+            forEachHelper(root, fn);
+        }
+
+        /**
+         * @brief Call a function for every key, in ascending key order.
+         * @param fn The function to call as fn(key).
+         */
+        template <typename Function>
+        void forEachKey(Function&& fn) const {
+            forEach([&](int key, const T&) { fn(key); });
         }
-    }
-
-    void insertKey(int key, const E& data) {
-        if (nodes.empty())
-            nodes.push_back(Node(key, data));
-        else
-            insert(0, key, data);
-    }
-
-    void removeKey(int key) {
-        if (!nodes.empty())
-            remove(0, key);
-    }
-
-    std::vector<int> getKeys() const {
-        std::vector<int> result;
-        if(nodes.size() == 0){
-            return result;
-        }
-        std::cout << "Nodes size: " << nodes.size() << std::endl;
-        for (int i=0; i<nodes.size(); i++)
-        {
-            std::cout << i << ' ' << nodes[i].key <<' ' << nodes[i].left << ' ' << nodes[i].right << std::endl;
-        }
-        keysHelper(0, result);
-        return result;
-    }
-
-    void keysHelper(int index, std::vector<int>& result) const {
-        std::cout << "push " << index << std::endl;
-        if (index >= 0 && index < nodes.size()) {
-            keysHelper(nodes[index].left, result);
-            result.push_back(nodes[index].key);
-            keysHelper(nodes[index].right, result);
-        }
-    }
-
-    std::vector<std::pair<int, E>> entries() const {
-        std::vector<std::pair<int, E>> result;
-        entriesHelper(0, result);
-        return result;
-    }
-
-    void entriesHelper(int index, std::vector<std::pair<int, E>>& result) const {
-        if (index == -1) return;
-        entriesHelper(nodes[index].left, result);
-        result.emplace_back(nodes[index].key, nodes[index].data);
-        entriesHelper(nodes[index].right, result);
-    }
-
-    std::vector<E> values() const {
-        std::vector<E> result;
-        valuesHelper(0, result);
-        return result;
-    }
-
-    void valuesHelper(int index, std::vector<E>& result) const {
-        if (index == -1) return;
-        valuesHelper(nodes[index].left, result);
-        result.push_back(nodes[index].data);
-        valuesHelper(nodes[index].right, result);
-    }
-
-    int size() const {
-        return nodes.size();
-    }
-};
\ No newline at end of file
+};
@@ -1,9 +1,11 @@
 #pragma once
 #include <iostream>
 #include <vector>
-#include <unordered_map>
+#include <algorithm>
 #include <utility>
-// #include "AVLTree.hxx"
+#include "adjacency.hxx"
+#include "parallel.hxx"
+#include "instrument.hxx"
 
 using std::vector;
 using std::pair;
@@ -13,14 +15,98 @@ using std::pair;
  * @brief Represents a directed graph.
  * @tparam V The type of data stored in each vertex.
  * @tparam E The type of data stored in each edge.
+ * @tparam AdjacencyPolicy The storage of adjacency rows: HashPolicy, SortedVectorPolicy, FlatHashPolicy or AVLPolicy.
  */
-template <typename V, typename E>
+template <typename V, typename E, typename AdjacencyPolicy = HashPolicy>
 class DiGraph
 {
+    public:
+        using Policy = AdjacencyPolicy;
+        using OutAdjacency = typename AdjacencyPolicy::template Map<E>;
+        using InAdjacency = typename AdjacencyPolicy::template Map<NoData>;
+
     private:
         vector<bool> valid;
         vector<V> vertexData;
-        vector<std::unordered_map<int, E>> edgeData;
+        vector<OutAdjacency> edgeData;
+        vector<InAdjacency> inEdgeData;
+        vector<int> inDegree, outDegree;
+        unsigned long long version = 0;
+
+        /** Batches with fewer edges than this are applied on the calling thread. */
+        static const int PARALLEL_BATCH = 4096;
+        /** Batches with at least 1/COUNTING_SORT_RATIO edges per vertex slot are grouped by counting sort. */
+        static const int COUNTING_SORT_RATIO = 16;
+
+        /**
+         * @brief Group the indices of a batch of edges by source or target vertex.
+         * Small batches are sorted, so only the vertices the batch touches cost anything; bulk
+         * batches (loads, generated graphs) use a linear counting sort over the vertex slots
+         * instead. Edges with an invalid endpoint are left out; the batch order is kept within
+         * each group.
+         * @param edges The batch of edges.
+         * @param bySource Flag indicating if edges are grouped by source (true) or target (false).
+         * @param keep If non-null, only edges whose flag is set are grouped.
+         * @param starts Set to the start of each group in order, followed by the size of order.
+         * @param order Set to the edge indices, grouped by vertex in ascending vertex order.
+         */
+        void groupEdges(const vector<pair<int, int>>& edges, bool bySource, const vector<char>* keep, vector<int>& starts, vector<int>& order) const {
+            auto vertexOf = [&](int k) {
+                return bySource ? edges[k].first : edges[k].second;
+            };
+            auto included = [&](int k) {
+                return (!keep || (*keep)[k]) && hasVertex(edges[k].first) && hasVertex(edges[k].second);
+            };
+            order.clear();
+            starts.clear();
+            int n = getSpan();
+            if (static_cast<long long>(edges.size()) * COUNTING_SORT_RATIO >= n) {
+                vector<int> offsets(n + 1, 0);
+                for (int k = 0; k < static_cast<int>(edges.size()); ++k) {
+                    if (included(k))
+                        offsets[vertexOf(k) + 1]++;
+                }
+                for (int u = 0; u < n; ++u) {
+                    if (offsets[u + 1] > 0)
+                        starts.push_back(offsets[u]);
+                    offsets[u + 1] += offsets[u];
+                }
+                order.resize(offsets[n]);
+                for (int k = 0; k < static_cast<int>(edges.size()); ++k) {
+                    if (included(k))
+                        order[offsets[vertexOf(k)]++] = k;
+                }
+                starts.push_back(order.size());
+                return;
+            }
+            for (int k = 0; k < static_cast<int>(edges.size()); ++k) {
+                if (included(k))
+                    order.push_back(k);
+            }
+            std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return vertexOf(a) < vertexOf(b); });
+            for (int i = 0; i < static_cast<int>(order.size()); ++i) {
+                if (i == 0 || vertexOf(order[i]) != vertexOf(order[i - 1]))
+                    starts.push_back(i);
+            }
+            starts.push_back(order.size());
+        }
+
+        /**
+         * @brief Call a function for every group made by groupEdges(), in parallel for large batches.
+         * @param pool The thread pool to run on.
+         * @param starts The group starts made by groupEdges().
+         * @param fn The function to call as fn(begin, end) with the range of a group in order.
+         */
+        template <typename Function>
+        void forEachGroup(ThreadPool& pool, const vector<int>& starts, Function&& fn) const {
+            int groups = starts.size() - 1;
+            if (starts.back() < PARALLEL_BATCH) {
+                for (int g = 0; g < groups; ++g)
+                    fn(starts[g], starts[g + 1]);
+                return;
+            }
+            parallelFor(pool, 0, groups, [&](int, int g) { fn(starts[g], starts[g + 1]); }, 64);
+        }
 
     public:
         int vertexCount = 0, edgeCount = 0;
@@ -41,6 +127,22 @@ class DiGraph
             return edgeCount;
         }
 
+        /**
+         * @brief Get the modification counter of the graph.
+         * @return A value that changes whenever the structure or edge data of the graph changes.
+         */
+        unsigned long long getVersion() const {
+            return version;
+        }
+
+        /**
+         * @brief Get the number of vertex slots in the graph, including removed vertices.
+         * @return One more than the largest vertex index ever allocated.
+         */
+        int getSpan() const {
+            return valid.size();
+        }
+
         /**
          * @brief Get the indices of the valid vertices in the graph.
          * @return A vector containing the indices of the valid vertices.
@@ -73,7 +175,7 @@ class DiGraph
          * @return True if the vertex exists, false otherwise.
          */
         bool hasVertex(int u) const {
-            return u < vertexCount && valid[u];
+            return u >= 0 && u < getSpan() && valid[u];
         }
 
         /**
@@ -83,7 +185,7 @@ class DiGraph
          * @return True if the edge exists, false otherwise.
          */
         bool hasEdge(int u, int v) const {
-            return u < vertexCount && edgeData[u].count(v) > 0;
+            return hasVertex(u) && edgeData[u].contains(v);
         }
 
         /**
@@ -92,14 +194,7 @@ class DiGraph
          * @return The in-degree of the vertex.
          */
         int getInDegree(int u) const {
-            if (!hasVertex(u))
-                return 0;
-            int degree = 0;
-            for (int v = 0; v < vertexCount; ++v) {
-                if (edgeData[v].count(u) > 0)
-                    ++degree;
-            }
-            return degree;
+            return hasVertex(u) ? inDegree[u] : 0;
         }
 
         /**
@@ -108,7 +203,7 @@ class DiGraph
          * @return The out-degree of the vertex.
          */
         int getOutDegree(int u) const {
-            return u < vertexCount ? edgeData[u].size() : 0;
+            return hasVertex(u) ? outDegree[u] : 0;
         }
 
         /**
@@ -117,13 +212,12 @@ class DiGraph
          * @return A vector containing the indices of the vertices that have an edge directed towards the given vertex.
          */
         std::vector<int> getInEdges(int u) const {
-            std::vector<int> result;
+            INSTRUMENT_SCOPE("DiGraph::getInEdges");
             if (!hasVertex(u))
-                return result; 
-            for (int v = 0; v < vertexCount; ++v) {
-                if (edgeData[v].count(u) > 0)
-                    result.push_back(v);
-            }
+                return std::vector<int>();
+            std::vector<int> result;
+            result.reserve(inEdgeData[u].size());
+            inEdgeData[u].forEachKey([&](int v) { result.push_back(v); });
             return result;
         }
 
@@ -133,14 +227,39 @@ class DiGraph
          * @return A vector containing the indices of the vertices that have an edge directed away from the given vertex.
          */
         std::vector<int> getOutEdges(int u) const {
+            INSTRUMENT_SCOPE("DiGraph::getOutEdges");
             if (!hasVertex(u))
                 return std::vector<int>();
             std::vector<int> result;
-            for (const auto& pair : edgeData[u])
-                result.push_back(pair.first);
+            result.reserve(edgeData[u].size());
+            edgeData[u].forEachKey([&](int v) { result.push_back(v); });
             return result;
         }
 
+        /**
+         * @brief Call a function for every edge directed away from the given vertex, without allocating.
+         * @param u The index of the vertex.
+         * @param fn The function to call as fn(v, data) for each edge (u, v).
+         */
+        template <typename Function>
+        void forEachOutEdge(int u, Function&& fn) const {
+            if (!hasVertex(u))
+                return;
+            edgeData[u].forEach(fn);
+        }
+
+        /**
+         * @brief Call a function for every edge directed towards the given vertex, without allocating.
+         * @param u The index of the vertex.
+         * @param fn The function to call as fn(v) for each edge (v, u).
+         */
+        template <typename Function>
+        void forEachInEdge(int u, Function&& fn) const {
+            if (!hasVertex(u))
+                return;
+            inEdgeData[u].forEachKey(fn);
+        }
+
         /**
          * @brief Clear the graph by removing all vertices and edges.
          */
@@ -148,8 +267,12 @@ class DiGraph
             valid.clear();
             vertexData.clear();
             edgeData.clear();
+            inEdgeData.clear();
+            inDegree.clear();
+            outDegree.clear();
             vertexCount = 0;
             edgeCount = 0;
+            version++;
         }
 
         /**
@@ -159,8 +282,12 @@ class DiGraph
         void addVertex(const V& newVertex = V()) {
             valid.push_back(true);
             vertexData.push_back(newVertex);
-            edgeData.emplace_back(std::unordered_map<int, E>());
+            edgeData.emplace_back();
+            inEdgeData.emplace_back();
+            inDegree.push_back(0);
+            outDegree.push_back(0);
             vertexCount++;
+            version++;
         }
 
         /**
@@ -170,10 +297,16 @@ class DiGraph
          * @param newEdge The data associated with the new edge.
          */
         void addEdge(int u, int v, const E& newEdge = E()) {
+            INSTRUMENT_SCOPE("DiGraph::addEdge");
             if (!hasVertex(u) || !hasVertex(v))
                 return;
-            edgeData[u].emplace(v, newEdge);
+            if (!edgeData[u].insert(v, newEdge))
+                return;
+            inEdgeData[v].insert(u);
+            outDegree[u]++;
+            inDegree[v]++;
             edgeCount++;
+            version++;
         }
 
         /**
@@ -183,10 +316,70 @@ class DiGraph
          * @param newEdge The data associated with the new edge.
          */
         void addEdgeChecked(int u, int v, const E& newEdge = E()) {
+            INSTRUMENT_SCOPE("DiGraph::addEdgeChecked");
             if (!hasVertex(u) || !hasVertex(v) || hasEdge(u, v))
                 return;
-            edgeData[u].emplace(v, newEdge);
+            edgeData[u].insert(v, newEdge);
+            inEdgeData[v].insert(u);
+            outDegree[u]++;
+            inDegree[v]++;
             edgeCount++;
+            version++;
+        }
+
+        /**
+         * @brief Add a batch of edges, filling the adjacency of different vertices in parallel.
+         * The batch is grouped by the sources and then the targets it touches, and the rows of each
+         * vertex are sized for its whole group before inserting. Small batches run on the calling thread. Edges with an invalid endpoint or that
+         * already exist are skipped; among duplicates within the batch the first one wins.
+         * @param edges The edges to add.
+         * @param data The data associated with each edge, or empty to use the default value.
+         * @param pool The thread pool to run on.
+         * @param added If non-null, set to 1 for every edge of the batch that was inserted and 0 otherwise.
+         * @return The number of edges inserted.
+         */
+        int addEdges(const vector<pair<int, int>>& edges, const vector<E>& data, ThreadPool& pool, vector<char>* added = nullptr) {
+            INSTRUMENT_SCOPE("DiGraph::addEdges");
+            vector<char> flags(edges.size(), 0);
+            vector<int> starts, order;
+            groupEdges(edges, true, nullptr, starts, order);
+            forEachGroup(pool, starts, [&](int begin, int end) {
+                int u = edges[order[begin]].first;
+                edgeData[u].reserve(edgeData[u].size() + (end - begin));
+                for (int i = begin; i < end; ++i) {
+                    int k = order[i];
+                    if (edgeData[u].insert(edges[k].second, data.empty() ? E() : data[k])) {
+                        flags[k] = 1;
+                        outDegree[u]++;
+                    }
+                }
+            });
+            groupEdges(edges, false, &flags, starts, order);
+            forEachGroup(pool, starts, [&](int begin, int end) {
+                int v = edges[order[begin]].second;
+                inEdgeData[v].reserve(inEdgeData[v].size() + (end - begin));
+                for (int i = begin; i < end; ++i)
+                    inEdgeData[v].insert(edges[order[i]].first);
+                inDegree[v] += end - begin;
+            });
+            int inserted = order.size();
+            edgeCount += inserted;
+            if (inserted > 0)
+                version++;
+            if (added)
+                added->swap(flags);
+            return inserted;
+        }
+
+        /**
+         * @brief Add a batch of edges on the calling thread.
+         * @param edges The edges to add.
+         * @param data The data associated with each edge, or empty to use the default value.
+         * @return The number of edges inserted.
+         */
+        int addEdges(const vector<pair<int, int>>& edges, const vector<E>& data = vector<E>()) {
+            ThreadPool pool(1);
+            return addEdges(edges, data, pool);
         }
 
         /**
@@ -195,10 +388,59 @@ class DiGraph
          * @param v The index of the second vertex.
          */
         void removeEdge(int u, int v) {
+            INSTRUMENT_SCOPE("DiGraph::removeEdge");
             if (!hasVertex(u) || !hasVertex(v) || !hasEdge(u, v))
                 return;
             edgeData[u].erase(v);
+            inEdgeData[v].erase(u);
+            outDegree[u]--;
+            inDegree[v]--;
             edgeCount--;
+            version++;
+        }
+
+        /**
+         * @brief Remove a batch of edges, updating the adjacency of different vertices in parallel.
+         * The batch is grouped by the sources and then the targets it touches, and small batches run
+         * on the calling thread. Edges that do not exist are skipped;
+         * among duplicates within the batch only the first one removes the edge.
+         * @param edges The edges to remove.
+         * @param pool The thread pool to run on.
+         * @param removed If non-null, set to 1 for every edge of the batch that was removed and 0 otherwise.
+         * @param removedData If non-null, set to the data each removed edge had (default data for skipped edges).
+         * @return The number of edges removed.
+         */
+        int removeEdges(const vector<pair<int, int>>& edges, ThreadPool& pool, vector<char>* removed = nullptr, vector<E>* removedData = nullptr) {
+            INSTRUMENT_SCOPE("DiGraph::removeEdges");
+            vector<char> flags(edges.size(), 0);
+            vector<int> starts, order;
+            if (removedData)
+                removedData->assign(edges.size(), E());
+            groupEdges(edges, true, nullptr, starts, order);
+            forEachGroup(pool, starts, [&](int begin, int end) {
+                int u = edges[order[begin]].first;
+                for (int i = begin; i < end; ++i) {
+                    int k = order[i];
+                    if (!edgeData[u].erase(edges[k].second, removedData ? &(*removedData)[k] : nullptr))
+                        continue;
+                    flags[k] = 1;
+                    outDegree[u]--;
+                }
+            });
+            groupEdges(edges, false, &flags, starts, order);
+            forEachGroup(pool, starts, [&](int begin, int end) {
+                int v = edges[order[begin]].second;
+                for (int i = begin; i < end; ++i)
+                    inEdgeData[v].erase(edges[order[i]].first);
+                inDegree[v] -= end - begin;
+            });
+            int erased = order.size();
+            edgeCount -= erased;
+            if (erased > 0)
+                version++;
+            if (removed)
+                removed->swap(flags);
+            return erased;
         }
 
         /**
@@ -208,8 +450,14 @@ class DiGraph
         void removeIncidentEdges(int u) {
             if (!hasVertex(u)) 
                 return;
-            for (int v : getInEdges(u))
-            removeEdge(v, u);
+            inEdgeData[u].forEachKey([&](int v) {
+                edgeData[v].erase(u);
+                outDegree[v]--;
+            });
+            edgeCount -= inEdgeData[u].size();
+            inEdgeData[u].clear();
+            inDegree[u] = 0;
+            version++;
         }
 
         /**
@@ -219,8 +467,14 @@ class DiGraph
         void removeOutgoingEdges(int u) {
             if (!hasVertex(u))
                 return;
+            edgeData[u].forEachKey([&](int v) {
+                inEdgeData[v].erase(u);
+                inDegree[v]--;
+            });
             edgeCount -= edgeData[u].size();
             edgeData[u].clear();
+            outDegree[u] = 0;
+            version++;
         }
 
         /**
@@ -228,13 +482,15 @@ class DiGraph
          * @param u The index of the vertex.
          */
         void removeVertex(int u) {
+            INSTRUMENT_SCOPE("DiGraph::removeVertex");
             if (!hasVertex(u))
                 return;
-            valid[u] = false;
-            vertexData[u] = V();
             removeIncidentEdges(u);
             removeOutgoingEdges(u);
+            valid[u] = false;
+            vertexData[u] = V();
             vertexCount--;
+            version++;
         }
 
         /**
@@ -268,7 +524,7 @@ class DiGraph
         E getEdgeData(int u, int v) const {
             if (!hasVertex(u) || !hasVertex(v) || !hasEdge(u, v))
                 return E();
-            return edgeData[u].at(v);
+            return *edgeData[u].find(v);
         }
 
         /**
@@ -280,7 +536,8 @@ class DiGraph
         void setEdgeData(int u, int v, const E& data) {
             if (!hasVertex(u) || !hasVertex(v) || !hasEdge(u, v))
                 return;
-            edgeData[u][v] = data;
+            *edgeData[u].find(v) = data;
+            version++;
         }
 
         /**
@@ -289,12 +546,11 @@ class DiGraph
          */
         vector<pair<int, int>> getAllEdges() const {
             vector<pair<int, int>> edges;
-            for (int u = 0; u < vertexCount; ++u) {
+            edges.reserve(edgeCount);
+            for (int u = 0; u < getSpan(); ++u) {
                 if (!valid[u])
                     continue;
-                for (int v : getOutEdges(u)) {
-                    edges.push_back({u, v});
-                }
+                edgeData[u].forEachKey([&](int v) { edges.push_back({u, v}); });
             }
             return edges;
         }
@@ -305,23 +561,20 @@ class DiGraph
          * @param graph The graph to print.
          * @return The output stream.
          */
-        friend std::ostream& operator<<(std::ostream& os, const DiGraph<V, E>& graph) {
-            for (int u = 0; u < graph.vertexCount; ++u) {
+        friend std::ostream& operator<<(std::ostream& os, const DiGraph& graph) {
+            for (int u = 0; u < graph.getSpan(); ++u) {
                 if (!graph.valid[u])
                     continue;
                 os << "Vertex " << u << ": " << graph.vertexData[u] << '\n';
                 os << "  Outgoing edges: ";
-                std::vector<int> outEdges = graph.getOutEdges(u);
-                for (int v : outEdges) {
-                    os << "(" << u << ", " << v << ", " << graph.edgeData[u].at(v) << ") ";
-                }
+                graph.edgeData[u].forEach([&](int v, const E& data) {
+                    os << "(" << u << ", " << v << ", " << data << ") ";
+                });
                 os << '\n';
                 os << "  Incoming edges: ";
-                auto inEdges = graph.getInEdges(u);
-                for (auto it = inEdges.begin(); it != inEdges.end(); ++it) {
-                    int v = *it;
-                    os << "(" << v << ", " << u << ", " << graph.edgeData[v].at(u) << ") ";
-                }
+                graph.inEdgeData[u].forEachKey([&](int v) {
+                    os << "(" << v << ", " << u << ", " << *graph.edgeData[v].find(u) << ") ";
+                });
                 os << '\n';
             }
             return os;
@@ -0,0 +1,445 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include "AVLTree.hxx"
+
+/**
+ * Adjacency containers for DiGraph. Each maps non-negative vertex indices to edge data and
+ * provides the same interface: size, empty, clear, reserve, contains, find, insert, erase,
+ * forEach and forEachKey. DiGraph picks one through an adjacency policy, whose Map<T>
+ * alias names the container for value type T (in-adjacency uses Map<NoData>) and whose
+ * ORDERED flag tells if rows are iterated in ascending key order.
+ */
+
+/**
+ * @struct NoData
+ * @brief The value type of adjacency sets, which only record keys.
+ */
+struct NoData {};
+
+/**
+ * @class HashAdjacency
+ * @brief An adjacency map backed by std::unordered_map (std::unordered_set for NoData).
+ * @tparam T The type of value stored with each key.
+ */
+template <typename T>
+class HashAdjacency
+{
+    private:
+        static constexpr bool HAS_VALUES = !std::is_same<T, NoData>::value;
+        using Container = std::conditional_t<HAS_VALUES, std::unordered_map<int, T>, std::unordered_set<int>>;
+
+        Container entries;
+        static inline T none{};
+
+        template <typename Iterator>
+        static T* valueOf(Iterator it) {
+            if constexpr (HAS_VALUES)
+                return const_cast<T*>(&it->second);
+            else
+                return &none;
+        }
+
+    public:
+        size_t size() const {
+            return entries.size();
+        }
+
+        bool empty() const {
+            return entries.empty();
+        }
+
+        void clear() {
+            entries.clear();
+        }
+
+        void reserve(size_t n) {
+            // std::unordered_map::reserve may rehash (even shrink) a large row, so only grow.
+            if (n > entries.bucket_count() * entries.max_load_factor())
+                entries.reserve(n);
+        }
+
+        bool contains(int key) const {
+            return entries.count(key) > 0;
+        }
+
+        const T* find(int key) const {
+            auto it = entries.find(key);
+            return it == entries.end() ? nullptr : valueOf(it);
+        }
+
+        T* find(int key) {
+            auto it = entries.find(key);
+            return it == entries.end() ? nullptr : valueOf(it);
+        }
+
+        bool insert(int key, const T& value = T()) {
+            if constexpr (HAS_VALUES)
+                return entries.emplace(key, value).second;
+            else
+                return entries.insert(key).second;
+        }
+
+        bool erase(int key, T* value = nullptr) {
+            auto it = entries.find(key);
+            if (it == entries.end())
+                return false;
+            if (value)
+                *value = *valueOf(it);
+            entries.erase(it);
+            return true;
+        }
+
+        template <typename Function>
+        void forEach(Function&& fn) const {
+            for (auto it = entries.begin(); it != entries.end(); ++it) {
+                if constexpr (HAS_VALUES)
+                    fn(it->first, it->second);
+                else
+                    fn(*it, none);
+            }
+        }
+
+        template <typename Function>
+        void forEachKey(Function&& fn) const {
+            forEach([&](int key, const T&) { fn(key); });
+        }
+};
+
+/**
+ * @class SortedVectorAdjacency
+ * @brief An adjacency map stored as a sorted array of keys and a parallel array of values.
+ * Lookups narrow the range with a branchless binary search and finish with a linear count over
+ * a short contiguous run of keys, which the compiler vectorizes. Iteration is in key order and
+ * touches only contiguous memory; insertion and erasure shift the tail of the row, so this
+ * suits read-heavy workloads with moderate degrees.
+ * @tparam T The type of value stored with each key.
+ */
+template <typename T>
+class SortedVectorAdjacency
+{
+    private:
+        static constexpr bool HAS_VALUES = !std::is_empty<T>::value;
+        static constexpr size_t LINEAR_SCAN = 16;
+
+        std::vector<int> keys;
+        std::vector<T> values;
+        static inline T none{};
+
+        /**
+         * @brief Get the position of the first key not less than the given key.
+         */
+        size_t lowerBound(int key) const {
+            const int* data = keys.data();
+            size_t base = 0, length = keys.size();
+            while (length > LINEAR_SCAN) {
+                size_t half = length / 2;
+                base = data[base + half] < key ? base + half : base;
+                length -= half;
+            }
+            size_t smaller = 0;
+            for (size_t i = 0; i < length; ++i)
+                smaller += data[base + i] < key;
+            return base + smaller;
+        }
+
+        T* valueAt(size_t pos) {
+            if constexpr (HAS_VALUES)
+                return &values[pos];
+            else
+                return &none;
+        }
+
+        const T* valueAt(size_t pos) const {
+            return const_cast<SortedVectorAdjacency*>(this)->valueAt(pos);
+        }
+
+    public:
+        size_t size() const {
+            return keys.size();
+        }
+
+        bool empty() const {
+            return keys.empty();
+        }
+
+        void clear() {
+            keys.clear();
+            values.clear();
+        }
+
+        void reserve(size_t n) {
+            keys.reserve(n);
+            if constexpr (HAS_VALUES)
+                values.reserve(n);
+        }
+
+        bool contains(int key) const {
+            size_t pos = lowerBound(key);
+            return pos < keys.size() && keys[pos] == key;
+        }
+
+        const T* find(int key) const {
+            size_t pos = lowerBound(key);
+            return pos < keys.size() && keys[pos] == key ? valueAt(pos) : nullptr;
+        }
+
+        T* find(int key) {
+            size_t pos = lowerBound(key);
+            return pos < keys.size() && keys[pos] == key ? valueAt(pos) : nullptr;
+        }
+
+        bool insert(int key, const T& value = T()) {
+            size_t pos = lowerBound(key);
+            if (pos < keys.size() && keys[pos] == key)
+                return false;
+            keys.insert(keys.begin() + pos, key);
+            if constexpr (HAS_VALUES)
+                values.insert(values.begin() + pos, value);
+            return true;
+        }
+
+        bool erase(int key, T* value = nullptr) {
+            size_t pos = lowerBound(key);
+            if (pos == keys.size() || keys[pos] != key)
+                return false;
+            if (value)
+                *value = *valueAt(pos);
+            keys.erase(keys.begin() + pos);
+            if constexpr (HAS_VALUES)
+                values.erase(values.begin() + pos);
+            return true;
+        }
+
+        template <typename Function>
+        void forEach(Function&& fn) const {
+            for (size_t i = 0; i < keys.size(); ++i)
+                fn(keys[i], *valueAt(i));
+        }
+
+        template <typename Function>
+        void forEachKey(Function&& fn) const {
+            for (int key : keys)
+                fn(key);
+        }
+};
+
+/**
+ * @class FlatHashAdjacency
+ * @brief An open-addressing hash map with linear probing over flat arrays of keys and values.
+ * Empty and erased slots are marked with negative sentinels, so keys must be non-negative.
+ * The table grows to keep live and erased slots under three quarters of the capacity, and
+ * empty rows allocate nothing.
+ * @tparam T The type of value stored with each key.
+ */
+template <typename T>
+class FlatHashAdjacency
+{
+    private:
+        static constexpr bool HAS_VALUES = !std::is_empty<T>::value;
+        static constexpr int EMPTY = -1, ERASED = -2;
+
+        std::vector<int> slots;
+        std::vector<T> values;
+        size_t count = 0, used = 0;
+        static inline T none{};
+
+        size_t home(int key) const {
+            return static_cast<size_t>((static_cast<uint64_t>(key) * 0x9e3779b97f4a7c15ULL) >> 32) & (slots.size() - 1);
+        }
+
+        /**
+         * @brief Get the slot holding a key, or -1 if it is absent.
+         */
+        long long locate(int key) const {
+            if (slots.empty())
+                return -1;
+            size_t mask = slots.size() - 1;
+            for (size_t i = home(key);; i = (i + 1) & mask) {
+                if (slots[i] == key)
+                    return i;
+                if (slots[i] == EMPTY)
+                    return -1;
+            }
+        }
+
+        void rehash(size_t capacity) {
+            std::vector<int> oldSlots(capacity, EMPTY);
+            std::vector<T> oldValues(HAS_VALUES ? capacity : 0);
+            oldSlots.swap(slots);
+            oldValues.swap(values);
+            size_t mask = capacity - 1;
+            for (size_t j = 0; j < oldSlots.size(); ++j) {
+                if (oldSlots[j] < 0)
+                    continue;
+                size_t i = home(oldSlots[j]);
+                while (slots[i] != EMPTY)
+                    i = (i + 1) & mask;
+                slots[i] = oldSlots[j];
+                if constexpr (HAS_VALUES)
+                    values[i] = std::move(oldValues[j]);
+            }
+            used = count;
+        }
+
+        static size_t capacityFor(size_t n) {
+            size_t capacity = 8;
+            while (capacity * 3 < n * 4)
+                capacity *= 2;
+            return capacity;
+        }
+
+        T* valueAt(size_t pos) {
+            if constexpr (HAS_VALUES)
+                return &values[pos];
+            else
+                return &none;
+        }
+
+        const T* valueAt(size_t pos) const {
+            return const_cast<FlatHashAdjacency*>(this)->valueAt(pos);
+        }
+
+    public:
+        size_t size() const {
+            return count;
+        }
+
+        bool empty() const {
+            return count == 0;
+        }
+
+        void clear() {
+            slots.clear();
+            values.clear();
+            count = used = 0;
+        }
+
+        void reserve(size_t n) {
+            if (n > 0 && capacityFor(n) > slots.size())
+                rehash(capacityFor(n));
+        }
+
+        bool contains(int key) const {
+            return locate(key) != -1;
+        }
+
+        const T* find(int key) const {
+            long long pos = locate(key);
+            return pos == -1 ? nullptr : valueAt(pos);
+        }
+
+        T* find(int key) {
+            long long pos = locate(key);
+            return pos == -1 ? nullptr : valueAt(pos);
+        }
+
+        bool insert(int key, const T& value = T()) {
+            if ((used + 1) * 4 > slots.size() * 3)
+                rehash(capacityFor(2 * (count + 1)));
+            size_t mask = slots.size() - 1;
+            long long target = -1;
+            size_t i = home(key);
+            for (;; i = (i + 1) & mask) {
+                if (slots[i] == key)
+                    return false;
+                if (slots[i] == EMPTY)
+                    break;
+                if (slots[i] == ERASED && target == -1)
+                    target = i;
+            }
+            if (target == -1) {
+                target = i;
+                used++;
+            }
+            slots[target] = key;
+            if constexpr (HAS_VALUES)
+                values[target] = value;
+            count++;
+            return true;
+        }
+
+        bool erase(int key, T* value = nullptr) {
+            long long pos = locate(key);
+            if (pos == -1)
+                return false;
+            if (value)
+                *value = *valueAt(pos);
+            slots[pos] = ERASED;
+            if constexpr (HAS_VALUES)
+                values[pos] = T();
+            count--;
+            if (count == 0)
+                clear();
+            return true;
+        }
+
+        template <typename Function>
+        void forEach(Function&& fn) const {
+            for (size_t i = 0; i < slots.size(); ++i) {
+                if (slots[i] >= 0)
+                    fn(slots[i], *valueAt(i));
+            }
+        }
+
+        template <typename Function>
+        void forEachKey(Function&& fn) const {
+            for (int key : slots) {
+                if (key >= 0)
+                    fn(key);
+            }
+        }
+};
+
+/**
+ * @struct HashPolicy
+ * @brief Adjacency in std::unordered_map rows: fast updates, highest memory per edge.
+ */
+struct HashPolicy {
+    /** Flag indicating if rows are visited in ascending key order. */
+    static constexpr bool ORDERED = false;
+
+    template <typename T>
+    using Map = HashAdjacency<T>;
+};
+
+/**
+ * @struct SortedVectorPolicy
+ * @brief Adjacency in sorted flat rows: compact and fast to scan, for read-heavy workloads such as BFS.
+ */
+struct SortedVectorPolicy {
+    /** Flag indicating if rows are visited in ascending key order. */
+    static constexpr bool ORDERED = true;
+
+    template <typename T>
+    using Map = SortedVectorAdjacency<T>;
+};
+
+/**
+ * @struct FlatHashPolicy
+ * @brief Adjacency in open-addressing rows: constant-time updates with flat memory, for insert-heavy deltas.
+ */
+struct FlatHashPolicy {
+    /** Flag indicating if rows are visited in ascending key order. */
+    static constexpr bool ORDERED = false;
+
+    template <typename T>
+    using Map = FlatHashAdjacency<T>;
+};
+
+/**
+ * @struct AVLPolicy
+ * @brief Adjacency in arena-backed AVL trees: ordered rows with logarithmic updates at high degree.
+ */
+struct AVLPolicy {
+    /** Flag indicating if rows are visited in ascending key order. */
+    static constexpr bool ORDERED = true;
+
+    template <typename T>
+    using Map = AVLTree<T>;
+};
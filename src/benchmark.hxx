@@ -0,0 +1,294 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "instrument.hxx"
+#include "timer.hxx"
+
+/**
+ * @class PerfCounters
+ * @brief Hardware counters for the calling thread, read through perf_event_open.
+ * Counts cycles, instructions, cache references and cache misses in user space. Work done on
+ * other threads (such as the workers of a thread pool) is not counted. If the kernel or
+ * container does not allow perf events, available() is false and all readings are zero.
+ */
+class PerfCounters
+{
+    public:
+        static const int COUNT = 4;
+
+    private:
+        int fds[COUNT] = {-1, -1, -1, -1};
+        unsigned long long totals[COUNT] = {};
+
+        static int open(unsigned long long config, int group) {
+            perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.size = sizeof(attr);
+            attr.config = config;
+            attr.disabled = group == -1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP;
+            return syscall(__NR_perf_event_open, &attr, 0, -1, group, 0);
+        }
+
+    public:
+        PerfCounters() {
+            const unsigned long long configs[COUNT] = {
+                PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                PERF_COUNT_HW_CACHE_REFERENCES, PERF_COUNT_HW_CACHE_MISSES};
+            for (int i = 0; i < COUNT; ++i) {
+                fds[i] = open(configs[i], i == 0 ? -1 : fds[0]);
+                if (fds[i] < 0) {
+                    close();
+                    return;
+                }
+            }
+        }
+
+        PerfCounters(const PerfCounters&) = delete;
+        PerfCounters& operator=(const PerfCounters&) = delete;
+
+        ~PerfCounters() {
+            close();
+        }
+
+        /**
+         * @brief Release the counters.
+         */
+        void close() {
+            for (int& fd : fds) {
+                if (fd >= 0)
+                    ::close(fd);
+                fd = -1;
+            }
+        }
+
+        /**
+         * @brief Check if the counters could be opened.
+         * @return True if readings are meaningful, false otherwise.
+         */
+        bool available() const {
+            return fds[0] >= 0;
+        }
+
+        /**
+         * @brief Get the names of the counters, in reading order.
+         * @param i The index of the counter.
+         * @return The name of the counter.
+         */
+        static const char* name(int i) {
+            static const char* names[COUNT] = {"cycles", "instructions", "cache_references", "cache_misses"};
+            return names[i];
+        }
+
+        /**
+         * @brief Reset and start counting.
+         */
+        void start() {
+            if (!available())
+                return;
+            ioctl(fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+
+        /**
+         * @brief Stop counting and add the readings to the running totals.
+         */
+        void stop() {
+            if (!available())
+                return;
+            ioctl(fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+            unsigned long long buffer[1 + COUNT] = {};
+            if (read(fds[0], buffer, sizeof(buffer)) > 0) {
+                for (int i = 0; i < COUNT && i < static_cast<int>(buffer[0]); ++i)
+                    totals[i] += buffer[1 + i];
+            }
+        }
+
+        /**
+         * @brief Get and clear the running total of a counter.
+         * @param i The index of the counter.
+         * @return The total since the last call.
+         */
+        unsigned long long take(int i) {
+            unsigned long long total = totals[i];
+            totals[i] = 0;
+            return total;
+        }
+};
+
+/**
+ * @struct BenchmarkResult
+ * @brief The timings of one benchmark over its measured runs.
+ */
+struct BenchmarkResult {
+    std::string name;
+    std::string graph;
+    /** The number of operations performed per run. */
+    long long items = 0;
+    /** The number of threads the benchmark ran on. */
+    int threads = 1;
+    /** The wall time of each measured run, in nanoseconds, sorted ascending. */
+    std::vector<long long> samples;
+    /** The mean hardware counter readings per run, if available and the benchmark ran on one thread. */
+    std::vector<std::pair<std::string, double>> counters;
+
+    /**
+     * @brief Get a percentile of the run times (nearest rank).
+     * @param p The percentile, in [0, 100].
+     * @return The run time at that percentile, in nanoseconds.
+     */
+    long long percentile(double p) const {
+        if (samples.empty())
+            return 0;
+        size_t rank = static_cast<size_t>(p / 100.0 * samples.size() + 0.999999);
+        return samples[std::min(samples.size(), std::max<size_t>(rank, 1)) - 1];
+    }
+
+    /**
+     * @brief Get the mean run time.
+     * @return The mean run time, in nanoseconds.
+     */
+    double mean() const {
+        double total = 0;
+        for (long long sample : samples)
+            total += sample;
+        return samples.empty() ? 0 : total / samples.size();
+    }
+};
+
+/**
+ * @class BenchmarkSuite
+ * @brief Runs benchmarks with warm-up and repetitions and reports them as JSON.
+ */
+class BenchmarkSuite
+{
+    private:
+        int warmup, repeats;
+        bool usePerf;
+        std::string graph;
+        int threads = 1;
+        std::vector<BenchmarkResult> results;
+
+    public:
+        /**
+         * @brief Create a suite.
+         * @param warmup The number of unmeasured runs before measuring.
+         * @param repeats The number of measured runs.
+         * @param usePerf Flag indicating if hardware counters should be collected.
+         */
+        BenchmarkSuite(int warmup, int repeats, bool usePerf) : warmup(warmup), repeats(std::max(1, repeats)), usePerf(usePerf) {}
+
+        /**
+         * @brief Set the name of the graph that following benchmarks run on.
+         * @param name The name of the graph.
+         */
+        void setGraph(const std::string& name) {
+            graph = name;
+        }
+
+        /**
+         * @brief Set the number of threads that following benchmarks run on.
+         * Hardware counters only see the calling thread, so they are collected only while this is 1.
+         * @param count The number of threads; 0 means all hardware threads.
+         */
+        void setThreads(int count) {
+            threads = count > 0 ? count : std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        /**
+         * @brief Run a benchmark.
+         * @tparam Function The type of the measured function.
+         * @tparam Reset The type of the reset function.
+         * @param name The name of the benchmark.
+         * @param items The number of operations the measured function performs per run.
+         * @param fn The measured function.
+         * @param reset An unmeasured function run after every run, e.g. to undo its changes.
+         * @return The result of the benchmark.
+         */
+        template <typename Function, typename Reset>
+        const BenchmarkResult& run(const std::string& name, long long items, Function&& fn, Reset&& reset) {
+            BenchmarkResult result;
+            result.name = name;
+            result.graph = graph;
+            result.items = items;
+            result.threads = threads;
+            for (int i = 0; i < warmup; ++i) {
+                fn();
+                reset();
+            }
+            PerfCounters perf;
+            bool counting = usePerf && threads == 1 && perf.available();
+            for (int i = 0; i < repeats; ++i) {
+                if (counting)
+                    perf.start();
+                long long elapsed = measureTimeNs(fn);
+                if (counting)
+                    perf.stop();
+                result.samples.push_back(elapsed);
+                reset();
+            }
+            std::sort(result.samples.begin(), result.samples.end());
+            if (counting) {
+                for (int i = 0; i < PerfCounters::COUNT; ++i)
+                    result.counters.push_back({PerfCounters::name(i), static_cast<double>(perf.take(i)) / repeats});
+            }
+            results.push_back(result);
+            return results.back();
+        }
+
+        /**
+         * @brief Run a benchmark that needs no reset between runs.
+         * @tparam Function The type of the measured function.
+         * @param name The name of the benchmark.
+         * @param items The number of operations the measured function performs per run.
+         * @param fn The measured function.
+         * @return The result of the benchmark.
+         */
+        template <typename Function>
+        const BenchmarkResult& run(const std::string& name, long long items, Function&& fn) {
+            return run(name, items, std::forward<Function>(fn), []() {});
+        }
+
+        /**
+         * @brief Write all results as a JSON document.
+         * @param os The output stream.
+         */
+        void writeJson(std::ostream& os) const {
+            os << "{\n  \"warmup\": " << warmup << ",\n  \"repeats\": " << repeats << ",\n  \"benchmarks\": [";
+            for (size_t i = 0; i < results.size(); ++i) {
+                const auto& r = results[i];
+                os << (i ? "," : "") << "\n    {\"name\": \"" << r.name << "\", \"graph\": \"" << r.graph
+                   << "\", \"items\": " << r.items << ", \"threads\": " << r.threads
+                   << ", \"ns\": {\"min\": " << r.samples.front() << ", \"p50\": " << r.percentile(50)
+                   << ", \"p90\": " << r.percentile(90) << ", \"p99\": " << r.percentile(99)
+                   << ", \"max\": " << r.samples.back() << ", \"mean\": " << static_cast<long long>(r.mean()) << "}"
+                   << ", \"ns_per_item\": " << (r.items > 0 ? static_cast<double>(r.percentile(50)) / r.items : 0.0);
+                if (!r.counters.empty()) {
+                    os << ", \"counters\": {";
+                    for (size_t j = 0; j < r.counters.size(); ++j)
+                        os << (j ? ", " : "") << "\"" << r.counters[j].first << "\": " << static_cast<long long>(r.counters[j].second);
+                    os << "}";
+                }
+                os << "}";
+            }
+            os << "\n  ]";
+#ifdef GRAPH_INSTRUMENT
+            os << ",\n  \"instrumentation\": ";
+            InstrumentCounter::reportJson(os);
+#endif
+            os << "\n}\n";
+        }
+};
@@ -1,22 +1,24 @@
 #pragma once
 #include <queue>
 #include <vector>
+#include <atomic>
 #include "Graph.hxx"
+#include "csr.hxx"
+#include "parallel.hxx"
 
 /**
  * @brief Performs breadth-first search on a directed graph starting from a given vertex.
- * @tparam V The type of the vertex in the graph.
- * @tparam E The type of the edge in the graph.
+ * @tparam G The type of the graph (DiGraph or CSRView).
  * @param graph The directed graph to perform breadth-first search on.
  * @param start The starting vertex for the breadth-first search.
  * @return A vector containing the vertices in the order they are visited during the traversal.
  */
-template <typename V, typename E>
-std::vector<int> breadthFirstSearch(const DiGraph<V, E>& graph, int start) {
+template <typename G>
+std::vector<int> breadthFirstSearch(const G& graph, int start) {
     std::vector<int> bfsOrder;
     if (!graph.hasVertex(start))
         return bfsOrder;
-    vector<bool> visited(graph.getOrder(), false);
+    vector<bool> visited(graph.getSpan(), false);
     std::queue<int> q;
     visited[start] = true;
     q.push(start);
@@ -24,12 +26,148 @@ std::vector<int> breadthFirstSearch(const DiGraph<V, E>& graph, int start) {
         int u = q.front();
         q.pop();
         bfsOrder.push_back(u);
-        for (int v : graph.getOutEdges(u)) {
+        graph.forEachOutEdge(u, [&](int v, const auto&) {
             if (!visited[v]) {
                 visited[v] = true;
                 q.push(v);
             }
-        }
+        });
     }
     return bfsOrder;
 }
+
+/**
+ * @struct BFSResult
+ * @brief The outcome of a breadth-first search.
+ */
+struct BFSResult {
+    /** The reached vertices in order of non-decreasing level. */
+    std::vector<int> order;
+    /** The level of each vertex, or -1 if it was not reached. */
+    std::vector<int> level;
+    /** The BFS-tree parent of each vertex, the start vertex for itself, or -1 if it was not reached. */
+    std::vector<int> parent;
+};
+
+/**
+ * @brief Performs a level-synchronous, direction-optimizing breadth-first search on multiple threads.
+ * Each level is expanded either top-down (frontier vertices claim unvisited out-neighbours
+ * through an atomic bitmap) or bottom-up (unvisited vertices look for a parent among their
+ * in-neighbours), switching on the frontier size as in Beamer et al. Bottom-up steps are
+ * only taken if the snapshot stores incoming edges.
+ * @tparam V The type of the vertex in the graph.
+ * @tparam E The type of the edge in the graph.
+ * @param graph The snapshot to perform breadth-first search on.
+ * @param start The starting vertex for the breadth-first search.
+ * @param pool The thread pool to run on.
+ * @param alpha Switch to bottom-up once the frontier's out-edges exceed 1/alpha of the unexplored out-edges.
+ * @param beta Switch back to top-down once the frontier holds fewer than 1/beta of the vertices.
+ * @return The visit order, levels and parents of the traversal.
+ */
+template <typename V, typename E>
+BFSResult parallelBreadthFirstSearch(const CSRView<V, E>& graph, int start, ThreadPool& pool, double alpha = 15, double beta = 18) {
+    BFSResult result;
+    int n = graph.getSpan();
+    result.level.assign(n, -1);
+    result.parent.assign(n, -1);
+    if (!graph.hasVertex(start))
+        return result;
+    int words = (n + 63) / 64;
+    std::vector<std::atomic<unsigned long long>> visited(words);
+    std::vector<unsigned long long> frontierBits(words, 0);
+    for (auto& word : visited)
+        word.store(0, std::memory_order_relaxed);
+    auto claim = [&](int v) {
+        unsigned long long bit = 1ULL << (v & 63);
+        return (visited[v >> 6].fetch_or(bit, std::memory_order_relaxed) & bit) == 0;
+    };
+    auto isVisited = [&](int v) {
+        return (visited[v >> 6].load(std::memory_order_relaxed) >> (v & 63)) & 1;
+    };
+
+    int threads = pool.size();
+    std::vector<std::vector<int>> nextLocal(threads);
+    std::vector<long long> scoutLocal(threads);
+    std::vector<int> frontier = {start};
+    claim(start);
+    result.level[start] = 0;
+    result.parent[start] = start;
+    result.order.reserve(graph.getOrder());
+    long long unexploredEdges = graph.getSize() - graph.getOutDegree(start);
+    long long frontierEdges = graph.getOutDegree(start);
+    bool bottomUp = false;
+
+    for (int depth = 0; !frontier.empty(); ++depth) {
+        result.order.insert(result.order.end(), frontier.begin(), frontier.end());
+        int frontierSize = frontier.size();
+        if (graph.hasInEdges()) {
+            if (!bottomUp && frontierEdges > unexploredEdges / alpha)
+                bottomUp = true;
+            else if (bottomUp && frontierSize < n / beta)
+                bottomUp = false;
+        }
+        for (int tid = 0; tid < threads; ++tid) {
+            nextLocal[tid].clear();
+            scoutLocal[tid] = 0;
+        }
+
+        if (bottomUp) {
+            std::fill(frontierBits.begin(), frontierBits.end(), 0);
+            for (int u : frontier)
+                frontierBits[u >> 6] |= 1ULL << (u & 63);
+            parallelFor(pool, 0, n, [&](int tid, int v) {
+                if (isVisited(v) || !graph.hasVertex(v))
+                    return;
+                for (int u : graph.getInEdges(v)) {
+                    if ((frontierBits[u >> 6] >> (u & 63)) & 1) {
+                        claim(v);
+                        result.level[v] = depth + 1;
+                        result.parent[v] = u;
+                        nextLocal[tid].push_back(v);
+                        scoutLocal[tid] += graph.getOutDegree(v);
+                        break;
+                    }
+                }
+            });
+        }
+        else {
+            parallelFor(pool, 0, frontierSize, [&](int tid, int i) {
+                int u = frontier[i];
+                for (int v : graph.getOutEdges(u)) {
+                    if (isVisited(v) || !claim(v))
+                        continue;
+                    result.level[v] = depth + 1;
+                    result.parent[v] = u;
+                    nextLocal[tid].push_back(v);
+                    scoutLocal[tid] += graph.getOutDegree(v);
+                }
+            }, 64);
+        }
+
+        frontier.clear();
+        frontierEdges = 0;
+        for (int tid = 0; tid < threads; ++tid) {
+            frontier.insert(frontier.end(), nextLocal[tid].begin(), nextLocal[tid].end());
+            frontierEdges += scoutLocal[tid];
+        }
+        unexploredEdges -= frontierEdges;
+    }
+    return result;
+}
+
+/**
+ * @brief Performs a parallel, direction-optimizing breadth-first search on a directed graph.
+ * Takes a snapshot of the graph with incoming edges and searches it on a temporary pool.
+ * @tparam V The type of the vertex in the graph.
+ * @tparam E The type of the edge in the graph.
+ * @param graph The directed graph to perform breadth-first search on.
+ * @param start The starting vertex for the breadth-first search.
+ * @param threads The number of threads to use; 0 uses all hardware threads.
+ * @return The visit order, levels and parents of the traversal.
+ */
+template <typename V, typename E, typename A>
+BFSResult parallelBreadthFirstSearch(const DiGraph<V, E, A>& graph, int start, int threads = 0) {
+    CSRView<V, E> csr(graph, true);
+    ThreadPool pool(threads);
+    return parallelBreadthFirstSearch(csr, start, pool);
+}
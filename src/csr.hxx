@@ -0,0 +1,437 @@
+#pragma once
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include "Graph.hxx"
+
+using std::vector;
+using std::pair;
+
+/**
+ * @class NeighbourRange
+ * @brief A non-owning view over a contiguous run of neighbours or edge values.
+ * @tparam T The type of the elements in the range.
+ */
+template <typename T>
+class NeighbourRange
+{
+    private:
+        const T* first = nullptr;
+        const T* last = nullptr;
+
+    public:
+        NeighbourRange() = default;
+        NeighbourRange(const T* first, const T* last) : first(first), last(last) {}
+
+        const T* begin() const { return first; }
+        const T* end() const { return last; }
+        int size() const { return static_cast<int>(last - first); }
+        bool empty() const { return first == last; }
+        const T& operator[](int i) const { return first[i]; }
+};
+
+/**
+ * @class CSRView
+ * @brief A frozen, compressed sparse row snapshot of a directed graph.
+ * Neighbour lists are stored contiguously and sorted by target, so iteration
+ * is allocation-free and edge lookups are binary searches. The snapshot does
+ * not follow later changes to the graph; use refresh() to bring it up to date.
+ * @tparam V The type of data stored in each vertex.
+ * @tparam E The type of data stored in each edge.
+ */
+template <typename V, typename E>
+class CSRView
+{
+    private:
+        vector<char> valid;
+        vector<int> offsets, targets;
+        vector<E> edgeValues;
+        vector<int> inDegree;
+        vector<int> inOffsets, sources;
+        bool withInEdges = false;
+        int vertexCount = 0;
+        unsigned long long version = 0;
+
+        /**
+         * @brief Write the sorted out-row of a vertex into the given arrays.
+         * @param graph The graph to read from.
+         * @param u The index of the vertex.
+         * @param pos The position of the first slot of the row.
+         * @param outTargets The target array to write to.
+         * @param outValues The edge value array to write to.
+         */
+        template <typename A>
+        static void fillOutRow(const DiGraph<V, E, A>& graph, int u, int pos, vector<int>& outTargets, vector<E>& outValues) {
+            vector<pair<int, E>> row;
+            row.reserve(graph.getOutDegree(u));
+            graph.forEachOutEdge(u, [&](int v, const E& data) { row.emplace_back(v, data); });
+            if constexpr (!A::ORDERED)
+                std::sort(row.begin(), row.end(), [](const pair<int, E>& a, const pair<int, E>& b) { return a.first < b.first; });
+            for (const auto& edge : row) {
+                outTargets[pos] = edge.first;
+                outValues[pos] = edge.second;
+                ++pos;
+            }
+        }
+
+        /**
+         * @brief Write the sorted in-row of a vertex into the given array.
+         * @param graph The graph to read from.
+         * @param u The index of the vertex.
+         * @param pos The position of the first slot of the row.
+         * @param outSources The source array to write to.
+         */
+        template <typename A>
+        static void fillInRow(const DiGraph<V, E, A>& graph, int u, int pos, vector<int>& outSources) {
+            int start = pos;
+            graph.forEachInEdge(u, [&](int v) { outSources[pos++] = v; });
+            if constexpr (!A::ORDERED)
+                std::sort(outSources.begin() + start, outSources.begin() + pos);
+        }
+
+        /**
+         * @brief Build the in-CSR arrays from the current out-CSR arrays.
+         */
+        void buildInEdges() {
+            int n = getSpan();
+            inOffsets.assign(n + 1, 0);
+            for (int u = 0; u < n; ++u)
+                inOffsets[u + 1] = inOffsets[u] + inDegree[u];
+            sources.resize(targets.size());
+            vector<int> cursor(inOffsets.begin(), inOffsets.end() - 1);
+            for (int u = 0; u < n; ++u) {
+                for (int i = offsets[u]; i < offsets[u + 1]; ++i)
+                    sources[cursor[targets[i]]++] = u;
+            }
+        }
+
+    public:
+        CSRView() = default;
+
+        /**
+         * @brief Build a snapshot of a graph.
+         * @param graph The graph to snapshot.
+         * @param withInEdges Flag indicating if the incoming edges should also be stored.
+         */
+        template <typename A>
+        explicit CSRView(const DiGraph<V, E, A>& graph, bool withInEdges = false) {
+            build(graph, withInEdges);
+        }
+
+        /**
+         * @brief Rebuild the snapshot from scratch.
+         * @param graph The graph to snapshot.
+         * @param withInEdges Flag indicating if the incoming edges should also be stored.
+         */
+        template <typename A>
+        void build(const DiGraph<V, E, A>& graph, bool withInEdges = false) {
+            int n = graph.getSpan();
+            this->withInEdges = withInEdges;
+            vertexCount = graph.getOrder();
+            valid.assign(n, 0);
+            offsets.assign(n + 1, 0);
+            inDegree.assign(n, 0);
+            for (int u = 0; u < n; ++u) {
+                valid[u] = graph.hasVertex(u);
+                inDegree[u] = graph.getInDegree(u);
+                offsets[u + 1] = offsets[u] + graph.getOutDegree(u);
+            }
+            targets.resize(offsets[n]);
+            edgeValues.resize(offsets[n]);
+            for (int u = 0; u < n; ++u)
+                fillOutRow(graph, u, offsets[u], targets, edgeValues);
+            if (withInEdges)
+                buildInEdges();
+            else {
+                inOffsets.clear();
+                sources.clear();
+            }
+            version = graph.getVersion();
+        }
+
+        /**
+         * @brief Check if the graph has changed since the snapshot was taken.
+         * @param graph The graph the snapshot was taken from.
+         * @return True if the snapshot is out of date, false otherwise.
+         */
+        template <typename A>
+        bool isStale(const DiGraph<V, E, A>& graph) const {
+            return version != graph.getVersion();
+        }
+
+        /**
+         * @brief Rebuild the snapshot if the graph has changed since it was taken.
+         * @param graph The graph the snapshot was taken from.
+         */
+        template <typename A>
+        void refresh(const DiGraph<V, E, A>& graph) {
+            if (isStale(graph))
+                build(graph, withInEdges);
+        }
+
+        /**
+         * @brief Bring the snapshot up to date after a delta has been applied to the graph.
+         * Only the rows of vertices touched by the delta are re-read from the graph; all
+         * other rows are copied over from the old snapshot. The graph must not have been
+         * changed by anything other than the delta since the snapshot was taken.
+         * @tparam Delta The type of the delta (anything with insertions and deletions edge lists).
+         * @param graph The graph the snapshot was taken from.
+         * @param delta The delta that was applied to the graph.
+         */
+        template <typename A, typename Delta>
+        void refresh(const DiGraph<V, E, A>& graph, const Delta& delta) {
+            if (!isStale(graph))
+                return;
+            int n = getSpan();
+            if (graph.getSpan() != n) {
+                build(graph, withInEdges);
+                return;
+            }
+            vector<char> dirtyOut(n, 0), dirtyIn(n, 0);
+            auto mark = [&](const pair<int, int>& edge) {
+                if (edge.first >= 0 && edge.first < n) dirtyOut[edge.first] = 1;
+                if (edge.second >= 0 && edge.second < n) dirtyIn[edge.second] = 1;
+            };
+            for (const auto& edge : delta.insertions) mark(edge);
+            for (const auto& edge : delta.deletions) mark(edge);
+
+            vector<int> newOffsets(n + 1, 0);
+            for (int u = 0; u < n; ++u) {
+                int degree = dirtyOut[u] ? graph.getOutDegree(u) : offsets[u + 1] - offsets[u];
+                newOffsets[u + 1] = newOffsets[u] + degree;
+            }
+            vector<int> newTargets(newOffsets[n]);
+            vector<E> newValues(newOffsets[n]);
+            for (int u = 0; u < n; ++u) {
+                if (dirtyOut[u]) {
+                    fillOutRow(graph, u, newOffsets[u], newTargets, newValues);
+                    continue;
+                }
+                std::copy(targets.begin() + offsets[u], targets.begin() + offsets[u + 1], newTargets.begin() + newOffsets[u]);
+                std::copy(edgeValues.begin() + offsets[u], edgeValues.begin() + offsets[u + 1], newValues.begin() + newOffsets[u]);
+            }
+            offsets.swap(newOffsets);
+            targets.swap(newTargets);
+            edgeValues.swap(newValues);
+
+            for (int u = 0; u < n; ++u) {
+                if (dirtyIn[u])
+                    inDegree[u] = graph.getInDegree(u);
+            }
+            if (withInEdges) {
+                vector<int> newInOffsets(n + 1, 0);
+                for (int u = 0; u < n; ++u)
+                    newInOffsets[u + 1] = newInOffsets[u] + inDegree[u];
+                vector<int> newSources(newInOffsets[n]);
+                for (int u = 0; u < n; ++u) {
+                    if (dirtyIn[u]) {
+                        fillInRow(graph, u, newInOffsets[u], newSources);
+                        continue;
+                    }
+                    std::copy(sources.begin() + inOffsets[u], sources.begin() + inOffsets[u + 1], newSources.begin() + newInOffsets[u]);
+                }
+                inOffsets.swap(newInOffsets);
+                sources.swap(newSources);
+            }
+            version = graph.getVersion();
+        }
+
+        /**
+         * @brief Get the number of vertices in the snapshot.
+         * @return The number of valid vertices.
+         */
+        int getOrder() const {
+            return vertexCount;
+        }
+
+        /**
+         * @brief Get the number of edges in the snapshot.
+         * @return The number of edges.
+         */
+        int getSize() const {
+            return targets.size();
+        }
+
+        /**
+         * @brief Get the number of vertex slots in the snapshot, including removed vertices.
+         * @return One more than the largest vertex index.
+         */
+        int getSpan() const {
+            return valid.size();
+        }
+
+        /**
+         * @brief Check if the snapshot stores incoming edges.
+         * @return True if getInEdges() is available, false otherwise.
+         */
+        bool hasInEdges() const {
+            return withInEdges;
+        }
+
+        /**
+         * @brief Get the indices of the valid vertices in the snapshot.
+         * @return A vector containing the indices of the valid vertices.
+         */
+        vector<int> getValidVertices() const {
+            vector<int> result;
+            for (int i = 0; i < getSpan(); ++i) {
+                if (valid[i])
+                    result.push_back(i);
+            }
+            return result;
+        }
+
+        /**
+         * @brief Check if a vertex with the given index exists in the snapshot.
+         * @param u The index of the vertex to check.
+         * @return True if the vertex exists, false otherwise.
+         */
+        bool hasVertex(int u) const {
+            return u >= 0 && u < getSpan() && valid[u];
+        }
+
+        /**
+         * @brief Check if an edge exists between two vertices.
+         * @param u The index of the first vertex.
+         * @param v The index of the second vertex.
+         * @return True if the edge exists, false otherwise.
+         */
+        bool hasEdge(int u, int v) const {
+            if (!hasVertex(u))
+                return false;
+            auto row = getOutEdges(u);
+            return std::binary_search(row.begin(), row.end(), v);
+        }
+
+        /**
+         * @brief Get the in-degree of a vertex.
+         * @param u The index of the vertex.
+         * @return The in-degree of the vertex.
+         */
+        int getInDegree(int u) const {
+            return hasVertex(u) ? inDegree[u] : 0;
+        }
+
+        /**
+         * @brief Get the out-degree of a vertex.
+         * @param u The index of the vertex.
+         * @return The out-degree of the vertex.
+         */
+        int getOutDegree(int u) const {
+            return hasVertex(u) ? offsets[u + 1] - offsets[u] : 0;
+        }
+
+        /**
+         * @brief Get the position of the first out-edge of a vertex in the edge arrays.
+         * @param u The index of the vertex.
+         * @return The offset of the out-row of the vertex.
+         */
+        int getOutOffset(int u) const {
+            return offsets[u];
+        }
+
+        /**
+         * @brief Get the row offsets of the snapshot; the out-row of vertex u is [offsets[u], offsets[u + 1]).
+         * @return A view over the getSpan() + 1 offsets.
+         */
+        NeighbourRange<int> getOffsets() const {
+            return NeighbourRange<int>(offsets.data(), offsets.data() + offsets.size());
+        }
+
+        /**
+         * @brief Get the targets of all edges, row by row.
+         * @return A view over the getSize() targets.
+         */
+        NeighbourRange<int> getTargets() const {
+            return NeighbourRange<int>(targets.data(), targets.data() + targets.size());
+        }
+
+        /**
+         * @brief Get the sorted targets of the edges directed away from the given vertex.
+         * @param u The index of the vertex.
+         * @return A view over the targets, valid until the snapshot is rebuilt.
+         */
+        NeighbourRange<int> getOutEdges(int u) const {
+            if (!hasVertex(u))
+                return NeighbourRange<int>();
+            return NeighbourRange<int>(targets.data() + offsets[u], targets.data() + offsets[u + 1]);
+        }
+
+        /**
+         * @brief Get the data of the edges directed away from the given vertex, in the order of getOutEdges().
+         * @param u The index of the vertex.
+         * @return A view over the edge data, valid until the snapshot is rebuilt.
+         */
+        NeighbourRange<E> getOutEdgeData(int u) const {
+            if (!hasVertex(u))
+                return NeighbourRange<E>();
+            return NeighbourRange<E>(edgeValues.data() + offsets[u], edgeValues.data() + offsets[u + 1]);
+        }
+
+        /**
+         * @brief Get the sorted sources of the edges directed towards the given vertex.
+         * The snapshot must have been built with incoming edges.
+         * @param u The index of the vertex.
+         * @return A view over the sources, valid until the snapshot is rebuilt.
+         */
+        NeighbourRange<int> getInEdges(int u) const {
+            if (!withInEdges || !hasVertex(u))
+                return NeighbourRange<int>();
+            return NeighbourRange<int>(sources.data() + inOffsets[u], sources.data() + inOffsets[u + 1]);
+        }
+
+        /**
+         * @brief Call a function for every edge directed away from the given vertex.
+         * @param u The index of the vertex.
+         * @param fn The function to call as fn(v, data) for each edge (u, v).
+         */
+        template <typename Function>
+        void forEachOutEdge(int u, Function&& fn) const {
+            if (!hasVertex(u))
+                return;
+            for (int i = offsets[u]; i < offsets[u + 1]; ++i)
+                fn(targets[i], edgeValues[i]);
+        }
+
+        /**
+         * @brief Call a function for every edge directed towards the given vertex.
+         * The snapshot must have been built with incoming edges.
+         * @param u The index of the vertex.
+         * @param fn The function to call as fn(v) for each edge (v, u).
+         */
+        template <typename Function>
+        void forEachInEdge(int u, Function&& fn) const {
+            for (int v : getInEdges(u))
+                fn(v);
+        }
+
+        /**
+         * @brief Get the data associated with an edge between two vertices.
+         * @param u The index of the first vertex.
+         * @param v The index of the second vertex.
+         * @return The data associated with the edge.
+         */
+        E getEdgeData(int u, int v) const {
+            if (!hasVertex(u))
+                return E();
+            auto row = getOutEdges(u);
+            auto it = std::lower_bound(row.begin(), row.end(), v);
+            if (it == row.end() || *it != v)
+                return E();
+            return edgeValues[it - targets.data()];
+        }
+
+        /**
+         * @brief Get all the edges in the snapshot.
+         * @return A vector containing pairs of vertex indices representing the edges.
+         */
+        vector<pair<int, int>> getAllEdges() const {
+            vector<pair<int, int>> edges;
+            edges.reserve(targets.size());
+            for (int u = 0; u < getSpan(); ++u) {
+                for (int i = offsets[u]; i < offsets[u + 1]; ++i)
+                    edges.push_back({u, targets[i]});
+            }
+            return edges;
+        }
+};
@@ -2,10 +2,15 @@
 
 #include <vector>
 #include <random>
+#include <cmath>
 #include <unordered_map>
 #include <iostream>
+#include <functional>
 #include "Graph.hxx"
 #include "edge.hxx"
+#include "sampler.hxx"
+#include "parallel.hxx"
+#include "instrument.hxx"
 
 using std::vector;
 using std::pair;
@@ -18,6 +23,21 @@ using std::discrete_distribution;
 using std::random_device;
 using std::mt19937;
 
+/**
+ * @struct DeltaStats
+ * @brief The outcome of applying a delta to a graph.
+ */
+struct DeltaStats {
+    /** The number of insertions that added an edge. */
+    int insertions = 0;
+    /** The number of insertions of an edge that already existed or had an invalid endpoint. */
+    int noopInsertions = 0;
+    /** The number of deletions that removed an edge. */
+    int deletions = 0;
+    /** The number of deletions of an edge that did not exist. */
+    int noopDeletions = 0;
+};
+
 /**
  * @class GraphDelta
  * @brief Represents the changes to a graph (insertions and deletions).
@@ -27,27 +47,105 @@ using std::mt19937;
 template <typename V, typename E>
 class GraphDelta {
 public:
+    /** A function called with the delta after it has been applied to a graph. */
+    using Listener = std::function<void(const GraphDelta<V, E>&)>;
+
     vector<pair<int, int>> insertions;
     vector<pair<int, int>> deletions;
+    /** The data of each inserted edge, or empty to insert edges with default data. */
+    vector<E> insertionData;
+    /** The seed every generated delta is derived from. */
+    unsigned long long seed = DEFAULT_SEED;
+    /** The number of threads used to generate deltas; 0 uses all hardware threads. */
+    int threads = 1;
+
+    /**
+     * @brief Creates an empty delta.
+     * Generated deltas depend only on the seed and the sequence of generate calls, not on the
+     * number of threads.
+     * @param seed The seed every generated delta is derived from.
+     * @param threads The number of threads used to generate deltas; 0 uses all hardware threads.
+     */
+    explicit GraphDelta(unsigned long long seed = DEFAULT_SEED, int threads = 1) : seed(seed), threads(threads) {}
+
+    /**
+     * @brief Copies the changes and the generator state of another delta.
+     * Listeners belong to the object they subscribed to and are not copied.
+     * @param other The delta to copy.
+     */
+    GraphDelta(const GraphDelta& other)
+        : insertions(other.insertions), deletions(other.deletions), insertionData(other.insertionData),
+          seed(other.seed), threads(other.threads), generation(other.generation) {}
+
+    /**
+     * @brief Moves the changes and the generator state out of another delta.
+     * Listeners stay subscribed to the other delta.
+     * @param other The delta to move from.
+     */
+    GraphDelta(GraphDelta&& other) noexcept
+        : insertions(std::move(other.insertions)), deletions(std::move(other.deletions)), insertionData(std::move(other.insertionData)),
+          seed(other.seed), threads(other.threads), generation(other.generation) {}
+
+    /**
+     * @brief Replaces the changes and the generator state with those of another delta.
+     * The listeners of this delta are kept; those of the other delta are not copied.
+     * @param other The delta to copy.
+     * @return This delta.
+     */
+    GraphDelta& operator=(const GraphDelta& other) {
+        if (this != &other) {
+            insertions = other.insertions;
+            deletions = other.deletions;
+            insertionData = other.insertionData;
+            seed = other.seed;
+            threads = other.threads;
+            generation = other.generation;
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Moves the changes and the generator state out of another delta.
+     * The listeners of this delta are kept; those of the other delta stay with it.
+     * @param other The delta to move from.
+     * @return This delta.
+     */
+    GraphDelta& operator=(GraphDelta&& other) noexcept {
+        if (this != &other) {
+            insertions = std::move(other.insertions);
+            deletions = std::move(other.deletions);
+            insertionData = std::move(other.insertionData);
+            seed = other.seed;
+            threads = other.threads;
+            generation = other.generation;
+        }
+        return *this;
+    }
 
     /**
      * @brief Generates a mixed delta of edge insertions and deletions.
+     * @tparam G The type of the graph (DiGraph or CSRView).
      * @param graph The original graph.
      * @param epsilon The proportion of insertions in the delta.
      * @param count The total number of changes in the delta.
      * @param strictDelta Flag indicating if each insertion/deletion should induce a change to the graph.
      */
-    void generateMixedDelta(const DiGraph<V, E>& graph, double epsilon, int count, bool strictDelta) {
-        static random_device rd;
-        static mt19937 rng(rd());
+    template <typename G>
+    void generateMixedDelta(const G& graph, double epsilon, int count, bool strictDelta) {
+        INSTRUMENT_SCOPE("GraphDelta::generateMixedDelta");
         int numInsertions = static_cast<int>(epsilon * count);
         int numDeletions = count - numInsertions;
-        insertions = getNewRandomEdges(graph, numInsertions, strictDelta);
-        deletions = getExistingRandomEdges(graph, numDeletions, strictDelta);
+        insertions = getNewRandomEdges(graph, numInsertions, strictDelta, nextSeed(), threads);
+        insertionData.clear();
+        deletions = getExistingRandomEdges(graph, numDeletions, strictDelta, nextSeed(), threads);
     }
 
     /**
      * @brief Generates an insertion delta using preferential attachment function.
+     * Vertices are drawn from an alias table over their preferential weights. With strictDelta,
+     * the delta is capped at the number of absent pairs whose ends can be drawn (zero-weight
+     * vertices never are, unless every weight is zero).
+     * @tparam G The type of the graph (DiGraph or CSRView).
      * @param graph The original graph.
      * @param count The total number of changes in the delta.
      * @param alpha The alpha parameter of the preferential attachment function.
@@ -56,65 +154,89 @@ public:
      * @param strictPreferential Flag indicating if both the source and target vertices are preferentially chosen.
      * @param strictDelta Flag indicating if each insertion should induce a change to the graph.
      */
-    void generatePreferentialAttachmentDelta(const DiGraph<V, E>& graph, int count, double alpha, double beta, double lambda, bool strictPreferential, bool strictDelta) {
-        static random_device rd;
-        static mt19937 rng(rd());
-        vector<pair<int, int>> result;
-        unordered_map<pair<int, int>, bool, PairHash> mp;
-        result.reserve(count);
+    template <typename G>
+    void generatePreferentialAttachmentDelta(const G& graph, int count, double alpha, double beta, double lambda, bool strictPreferential, bool strictDelta) {
+        INSTRUMENT_SCOPE("GraphDelta::generatePreferentialAttachmentDelta");
+        insertions.clear();
+        insertionData.clear();
         auto vertices = graph.getValidVertices();
-        int n = vertices.size();
-        vector<double> f(n);
-        double total_f = 0.0;
+        long long n = vertices.size();
+        unsigned long long callSeed = nextSeed();
+        if (n == 0)
+            return;
+        vector<double> f = preferentialWeights(graph, alpha, beta, lambda);
+        vector<double> vertexWeights(n);
+        long long positive = 0;
         for (int i = 0; i < n; ++i) {
-            double d = graph.getInDegree(vertices[i]);
-            double wt = exp(alpha + beta * log(1 + d)) - lambda;
-            if (wt < 0) wt = 0; 
-            f[i] = wt;
-            total_f += wt;
+            vertexWeights[i] = f[vertices[i]];
+            positive += vertexWeights[i] > 0;
         }
-        for (double& p : f) {
-            p /= total_f;
+        if (positive == 0) {
+            std::fill(vertexWeights.begin(), vertexWeights.end(), 1.0);
+            positive = n;
         }
-        discrete_distribution<int> vertexDist(f.begin(), f.end());
-        while (result.size() < std::min(count,n*n)) {
-            int u,v;
-            if(strictPreferential){
-                u = vertices[vertexDist(rng)];
-                v = vertices[vertexDist(rng)];
-            }
-            else{
-                u = getRandomElement(vertices, rng);
-                v = vertices[vertexDist(rng)];
+        AliasTable vertexDist(vertexWeights);
+        auto draw = [&](RandomStream& rng) {
+            int u = strictPreferential ? vertices[vertexDist.sample(rng)] : vertices[rng.uniform(n)];
+            int v = vertices[vertexDist.sample(rng)];
+            return make_pair(u, v);
+        };
+        if (!strictDelta) {
+            insertions = sampleEdges(std::min<long long>(count, n*n), false, callSeed, threads, draw);
+            return;
+        }
+
+        // Zero-weight vertices are never drawn as targets (nor as sources if both ends are
+        // preferential), so only absent pairs between drawable vertices can be inserted.
+        long long sources = strictPreferential ? positive : n;
+        long long reachable = sources * positive - graph.getSize();
+        if (positive < n) {
+            vector<char> drawable(graph.getSpan(), 0);
+            for (int i = 0; i < n; ++i)
+                drawable[vertices[i]] = vertexWeights[i] > 0;
+            reachable = sources * positive;
+            for (int u : vertices) {
+                if (strictPreferential && !drawable[u])
+                    continue;
+                graph.forEachOutEdge(u, [&](int v, const auto&) { reachable -= drawable[v]; });
             }
-            if(strictDelta){
-                if(strictPreferential){
-                    while (graph.hasEdge(u, v)) {
-                        u = vertices[vertexDist(rng)];
-                        v = vertices[vertexDist(rng)];
-                    }
-                }
-                else{
-                    while (graph.hasEdge(u, v)) {
-                        u = getRandomElement(vertices, rng);
-                        v = vertices[vertexDist(rng)];
-                    }
+        }
+        int target = std::min<long long>(count, reachable);
+        if (target <= 0)
+            return;
+        if (4LL * target > reachable) {
+            // Too close to the population for rejection to converge quickly, so the absent
+            // drawable pairs (fewer than 4 * count plus the edges) are listed and sampled directly.
+            vector<pair<int, int>> pairs;
+            vector<double> pairWeights;
+            for (int i = 0; i < n; ++i) {
+                if (strictPreferential && vertexWeights[i] <= 0)
+                    continue;
+                for (int j = 0; j < n; ++j) {
+                    if (vertexWeights[j] <= 0 || graph.hasEdge(vertices[i], vertices[j]))
+                        continue;
+                    pairs.push_back({vertices[i], vertices[j]});
+                    pairWeights.push_back((strictPreferential ? vertexWeights[i] : 1.0) * vertexWeights[j]);
                 }
-                pair<int, int> edge = make_pair(u, v);
-                if (mp.count(edge)) continue;
-                result.push_back(edge);
-                mp[edge] = true;
-            }
-            else{
-                pair<int, int> edge = make_pair(u, v);
-                result.push_back(edge);
             }
+            for (int i : sampleWeightedDistinct(pairWeights, target, callSeed, threads))
+                insertions.push_back(pairs[i]);
+            return;
         }
-        insertions = result;
+        insertions = sampleEdges(target, true, callSeed, threads, [&](RandomStream& rng) {
+            pair<int, int> edge = draw(rng);
+            while (graph.hasEdge(edge.first, edge.second))
+                edge = draw(rng);
+            return edge;
+        });
     }
 
     /**
      * @brief Generates a deletion delta using preferential function.
+     * With strictDelta, existing edges are drawn directly from an alias table weighted by the
+     * preferential weights of their endpoints, which gives the same distribution as drawing
+     * preferential vertex pairs until one is an edge.
+     * @tparam G The type of the graph (DiGraph or CSRView).
      * @param graph The original graph.
      * @param count The total number of changes in the delta.
      * @param alpha The alpha parameter of the preferential function.
@@ -123,66 +245,59 @@ public:
      * @param strictPreferential Flag indicating if both the source and target vertices are preferentially chosen.
      * @param strictDelta Flag indicating if each deletion should induce a change to the graph.
      */
-    void generatePreferentialDetachmentDelta(const DiGraph<V, E>& graph, int count, double alpha, double beta, double lambda, bool strictPreferential, bool strictDelta) {
-        static random_device rd;
-        static mt19937 rng(rd());
-        vector<pair<int, int>> result;
-        unordered_map<pair<int, int>, bool, PairHash> mp;
-        result.reserve(count);
+    template <typename G>
+    void generatePreferentialDetachmentDelta(const G& graph, int count, double alpha, double beta, double lambda, bool strictPreferential, bool strictDelta) {
+        INSTRUMENT_SCOPE("GraphDelta::generatePreferentialDetachmentDelta");
+        deletions.clear();
         auto vertices = graph.getValidVertices();
-        int n = vertices.size();
-        int numEdges = graph.getSize();
-        vector<double> f(n);
-        double total_f = 0.0;
-        for (int i = 0; i < n; ++i) {
-            double d = graph.getInDegree(vertices[i]);
-            double wt = exp(alpha + beta * log(1 + d)) - lambda;
-            if (wt < 0) wt = 0; 
-            f[i] = wt;
-            total_f += wt;
-        }
-        for (double& p : f) {
-            p /= total_f;
-        }
-        discrete_distribution<int> vertexDist(f.begin(), f.end());
-        while (result.size() < std::min(count,numEdges)) {
-            int u,v;
-            if(strictPreferential){
-                u = vertices[vertexDist(rng)];
-                v = vertices[vertexDist(rng)];
-            }
-            else{
-                u = getRandomElement(vertices, rng);
-                v = vertices[vertexDist(rng)];
-            }
-            if(strictDelta){
-                if(strictPreferential){
-                    while (!graph.hasEdge(u, v)) {
-                        u = vertices[vertexDist(rng)];
-                        v = vertices[vertexDist(rng)];
-                    }
-                }
-                else{
-                    while (!graph.hasEdge(u, v)) {
-                        u = getRandomElement(vertices, rng);
-                        v = vertices[vertexDist(rng)];
-                    }
+        long long n = vertices.size();
+        long long numEdges = graph.getSize();
+        unsigned long long callSeed = nextSeed();
+        if (n == 0 || count <= 0)
+            return;
+        vector<double> f = preferentialWeights(graph, alpha, beta, lambda);
+        if (strictDelta) {
+            OutEdgeIndex<G> index(graph);
+            vector<double> edgeWeights(index.size());
+            long long positive = 0;
+            for (int u = 0; u < graph.getSpan(); ++u) {
+                for (int i = index.offset(u); i < index.offset(u + 1); ++i) {
+                    int v = index.target(i);
+                    edgeWeights[i] = strictPreferential ? f[u] * f[v] : f[v];
+                    positive += edgeWeights[i] > 0;
                 }
-                pair<int, int> edge = make_pair(u, v);
-                if (mp.count(edge)) continue;
-                result.push_back(edge);
-                mp[edge] = true;
             }
-            else{
-                pair<int, int> edge = make_pair(u, v);
-                result.push_back(edge);
+            if (positive == 0) {
+                std::fill(edgeWeights.begin(), edgeWeights.end(), 1.0);
+                positive = numEdges;
             }
+            int target = std::min<long long>(count, positive);
+            if (4LL * target > positive) {
+                // Too close to the population for draw-and-dedup to converge quickly.
+                for (int i : sampleWeightedDistinct(edgeWeights, target, callSeed, threads))
+                    deletions.push_back(index.edge(i));
+                return;
+            }
+            AliasTable edgeDist(edgeWeights);
+            deletions = sampleEdges(target, true, callSeed, threads, [&](RandomStream& rng) {
+                return index.edge(edgeDist.sample(rng));
+            });
+            return;
         }
-        deletions = result;
+        vector<double> vertexWeights(n);
+        for (int i = 0; i < n; ++i)
+            vertexWeights[i] = f[vertices[i]];
+        AliasTable vertexDist(vertexWeights);
+        deletions = sampleEdges(std::min<long long>(count, numEdges), false, callSeed, threads, [&](RandomStream& rng) {
+            int u = strictPreferential ? vertices[vertexDist.sample(rng)] : vertices[rng.uniform(n)];
+            int v = vertices[vertexDist.sample(rng)];
+            return make_pair(u, v);
+        });
     }
 
     /** 
      * @brief Generates a mixed delta of edge insertions and deletions using preferential function.
+     * @tparam G The type of the graph (DiGraph or CSRView).
      * @param graph The original graph.
      * @param count The total number of changes in the delta.
      * @param alpha The alpha parameter of the preferential attachment function.
@@ -192,9 +307,9 @@ public:
      * @param strictDelta Flag indicating if each insertion/deletion should induce a change to the graph.
      * @param epsilon The fraction of insertions in the delta.
      */
-    void generatePreferentialMixedDelta(const DiGraph<V, E>& graph, int count, double alpha, double beta, double lambda, bool strictPreferential, bool strictDelta, double epsilon) {
-        static random_device rd;
-        static mt19937 rng(rd());
+    template <typename G>
+    void generatePreferentialMixedDelta(const G& graph, int count, double alpha, double beta, double lambda, bool strictPreferential, bool strictDelta, double epsilon) {
+        INSTRUMENT_SCOPE("GraphDelta::generatePreferentialMixedDelta");
         int numInsertions = static_cast<int>(epsilon * count);
         int numDeletions = count - numInsertions;
         generatePreferentialAttachmentDelta(graph, numInsertions, alpha, beta, lambda, strictPreferential, strictDelta);
@@ -205,13 +320,94 @@ public:
      * @brief Applies the current delta to a graph.
      * @param graph The graph to apply the delta to.
      */
-    void applyCurrentDelta(DiGraph<V, E>& graph) {
-        for (const auto& edge: insertions) {
-            graph.addEdge(edge.first, edge.second);
+    template <typename A>
+    void applyCurrentDelta(DiGraph<V, E, A>& graph) {
+        INSTRUMENT_SCOPE("GraphDelta::applyCurrentDelta");
+        for (int i = 0; i < static_cast<int>(insertions.size()); ++i) {
+            graph.addEdge(insertions[i].first, insertions[i].second, insertionData.empty() ? E() : insertionData[i]);
         }
         for (const auto& edge: deletions) {
             graph.removeEdge(edge.first, edge.second);
         }
+        notifyListeners();
+    }
+
+    /**
+     * @brief Applies the current delta to a graph as a batch.
+     * Insertions and then deletions are bucketed by source vertex and applied per vertex in
+     * parallel; the result is the same as applyCurrentDelta(). Optionally records the inverse
+     * delta, which restores the graph (including the data of deleted edges) when applied.
+     * @param graph The graph to apply the delta to.
+     * @param pool The thread pool to run on.
+     * @param inverse If non-null, set to the delta that undoes this application.
+     * @return The number of effective and no-op insertions and deletions.
+     */
+    template <typename A>
+    DeltaStats applyBatch(DiGraph<V, E, A>& graph, ThreadPool& pool, GraphDelta<V, E>* inverse = nullptr) const {
+        INSTRUMENT_SCOPE("GraphDelta::applyBatch");
+        DeltaStats stats;
+        vector<char> added, removed;
+        vector<E> removedData;
+        stats.insertions = graph.addEdges(insertions, insertionData, pool, &added);
+        stats.deletions = graph.removeEdges(deletions, pool, &removed, inverse ? &removedData : nullptr);
+        stats.noopInsertions = insertions.size() - stats.insertions;
+        stats.noopDeletions = deletions.size() - stats.deletions;
+        if (inverse) {
+            inverse->clearDelta();
+            inverse->insertions.reserve(stats.deletions);
+            inverse->insertionData.reserve(stats.deletions);
+            inverse->deletions.reserve(stats.insertions);
+            for (int i = 0; i < static_cast<int>(deletions.size()); ++i) {
+                if (!removed[i])
+                    continue;
+                inverse->insertions.push_back(deletions[i]);
+                inverse->insertionData.push_back(removedData[i]);
+            }
+            for (int i = 0; i < static_cast<int>(insertions.size()); ++i) {
+                if (added[i])
+                    inverse->deletions.push_back(insertions[i]);
+            }
+        }
+        notifyListeners();
+        return stats;
+    }
+
+    /**
+     * @brief Applies the current delta to a graph as a batch on a temporary thread pool.
+     * @param graph The graph to apply the delta to.
+     * @param threads The number of threads to use; 0 uses all hardware threads.
+     * @param inverse If non-null, set to the delta that undoes this application.
+     * @return The number of effective and no-op insertions and deletions.
+     */
+    template <typename A>
+    DeltaStats applyBatch(DiGraph<V, E, A>& graph, int threads = 0, GraphDelta<V, E>* inverse = nullptr) const {
+        ThreadPool pool(threads);
+        return applyBatch(graph, pool, inverse);
+    }
+
+    /**
+     * @brief Registers a function to be called every time this delta is applied to a graph.
+     * Listeners run on the calling thread after the graph has been updated, in order of
+     * registration, and see the delta as it was applied (including no-op changes).
+     * @param listener The function to call.
+     * @return An id that can be passed to unsubscribe().
+     */
+    int subscribe(Listener listener) {
+        listeners.emplace_back(nextListenerId, std::move(listener));
+        return nextListenerId++;
+    }
+
+    /**
+     * @brief Removes a listener registered with subscribe().
+     * @param id The id returned by subscribe().
+     */
+    void unsubscribe(int id) {
+        for (auto it = listeners.begin(); it != listeners.end(); ++it) {
+            if (it->first == id) {
+                listeners.erase(it);
+                return;
+            }
+        }
     }
 
     /**
@@ -220,6 +416,7 @@ public:
     void clearDelta() {
         insertions.clear();
         deletions.clear();
+        insertionData.clear();
     }
 
     /**
@@ -237,4 +434,47 @@ public:
         }
         return os;
     }
+
+private:
+    unsigned long long generation = 0;
+    vector<pair<int, Listener>> listeners;
+    int nextListenerId = 0;
+
+    /**
+     * @brief Calls every registered listener with this delta.
+     */
+    void notifyListeners() const {
+        for (const auto& listener : listeners)
+            listener.second(*this);
+    }
+
+    /**
+     * @brief Gets the seed of the next generate call and advances the call counter.
+     * @return The seed of the call.
+     */
+    unsigned long long nextSeed() {
+        return RandomStream::derive(seed, generation++);
+    }
+
+    /**
+     * @brief Computes the preferential weight of every vertex slot from its in-degree.
+     * @tparam G The type of the graph (DiGraph or CSRView).
+     * @param graph The original graph.
+     * @param alpha The alpha parameter of the preferential function.
+     * @param beta The beta parameter of the preferential function.
+     * @param lambda The lambda parameter of the preferential function.
+     * @return The weight of each vertex index, clamped at zero (zero for removed vertices).
+     */
+    template <typename G>
+    static vector<double> preferentialWeights(const G& graph, double alpha, double beta, double lambda) {
+        vector<double> f(graph.getSpan(), 0.0);
+        for (int u = 0; u < graph.getSpan(); ++u) {
+            if (!graph.hasVertex(u))
+                continue;
+            double d = graph.getInDegree(u);
+            double wt = exp(alpha + beta * log(1 + d)) - lambda;
+            f[u] = wt < 0 ? 0 : wt;
+        }
+        return f;
+    }
 };
\ No newline at end of file
@@ -0,0 +1,336 @@
+#pragma once
+#include <iostream>
+#include <queue>
+#include <vector>
+#include <utility>
+#include <climits>
+#include <functional>
+#include "Graph.hxx"
+#include "parallel.hxx"
+
+/**
+ * @class IncrementalBFS
+ * @brief Maintains BFS levels and parents from a set of source vertices as deltas are applied to a graph.
+ * After each delta only the part of every BFS tree that can have changed is recomputed.
+ * Deletions are repaired first, in the style of Ramalingam and Reps: the subtrees hanging
+ * below removed tree edges are detached, and each detached vertex is re-levelled from its
+ * in-neighbours that kept their level, in level order. Insertions are repaired afterwards by
+ * relaxing the inserted edges and propagating level decreases forward, again in level order.
+ * The work is proportional to the changed region rather than to the graph.
+ * Changes made to the graph by anything other than the deltas passed to update() (such as
+ * removing vertices) require a call to recompute().
+ * @tparam G The type of the graph (DiGraph).
+ */
+template <typename G>
+class IncrementalBFS
+{
+    private:
+        static const int PENDING = -2;
+
+        /**
+         * @brief Scratch space of one thread, sized to the graph and kept between updates.
+         */
+        struct Workspace {
+            vector<int> tentative;
+            vector<int> affected;
+            std::priority_queue<pair<int, int>, vector<pair<int, int>>, std::greater<pair<int, int>>> heap;
+        };
+
+        const G& graph;
+        vector<int> sources;
+        vector<vector<int>> levels, parents;
+        vector<Workspace> workspaces;
+        bool validating = false;
+
+        /**
+         * @brief Run a full breadth-first search from one source.
+         * @param start The source vertex.
+         * @param level Set to the level of each vertex, or -1 if it is not reached.
+         * @param parent Set to the BFS-tree parent of each vertex, the source for itself, or -1.
+         */
+        void search(int start, vector<int>& level, vector<int>& parent) const {
+            level.assign(graph.getSpan(), -1);
+            parent.assign(graph.getSpan(), -1);
+            if (!graph.hasVertex(start))
+                return;
+            std::queue<int> q;
+            level[start] = 0;
+            parent[start] = start;
+            q.push(start);
+            while (!q.empty()) {
+                int u = q.front();
+                q.pop();
+                graph.forEachOutEdge(u, [&](int v, const auto&) {
+                    if (level[v] == -1) {
+                        level[v] = level[u] + 1;
+                        parent[v] = u;
+                        q.push(v);
+                    }
+                });
+            }
+        }
+
+        /**
+         * @brief Grow the per-source arrays and workspaces if vertices were added to the graph.
+         * @param threads The number of workspaces needed.
+         */
+        void fit(int threads) {
+            size_t n = graph.getSpan();
+            for (size_t i = 0; i < sources.size(); ++i) {
+                if (levels[i].size() < n) {
+                    levels[i].resize(n, -1);
+                    parents[i].resize(n, -1);
+                }
+            }
+            if (static_cast<int>(workspaces.size()) < threads)
+                workspaces.resize(threads);
+            for (auto& workspace : workspaces) {
+                if (workspace.tentative.size() < n)
+                    workspace.tentative.resize(n, INT_MAX);
+            }
+        }
+
+        /**
+         * @brief Settle vertices in level order, lowering the levels of their out-neighbours.
+         * Vertices on the heap whose entry is outdated are skipped. If pendingOnly is set, only
+         * detached (PENDING) out-neighbours are relaxed, through the tentative levels.
+         */
+        void settle(vector<int>& level, vector<int>& parent, Workspace& ws, bool pendingOnly) const {
+            auto& heap = ws.heap;
+            while (!heap.empty()) {
+                int d = heap.top().first, u = heap.top().second;
+                heap.pop();
+                if (pendingOnly) {
+                    if (level[u] != PENDING || ws.tentative[u] != d)
+                        continue;
+                    level[u] = d;
+                } else if (level[u] != d) {
+                    continue;
+                }
+                graph.forEachOutEdge(u, [&](int v, const auto&) {
+                    if (pendingOnly) {
+                        if (level[v] == PENDING && d + 1 < ws.tentative[v]) {
+                            ws.tentative[v] = d + 1;
+                            parent[v] = u;
+                            heap.push({d + 1, v});
+                        }
+                    } else if (level[v] == -1 || d + 1 < level[v]) {
+                        level[v] = d + 1;
+                        parent[v] = u;
+                        heap.push({d + 1, v});
+                    }
+                });
+            }
+        }
+
+        /**
+         * @brief Repair the levels and parents of one source after a delta.
+         * @param i The index of the source.
+         * @param delta The applied delta.
+         * @param ws The scratch space to use.
+         */
+        template <typename Delta>
+        void repair(int i, const Delta& delta, Workspace& ws) {
+            vector<int>& level = levels[i];
+            vector<int>& parent = parents[i];
+            int source = sources[i];
+            auto& affected = ws.affected;
+
+            // Detach every subtree whose root lost its tree edge.
+            affected.clear();
+            for (const auto& edge : delta.deletions) {
+                int u = edge.first, v = edge.second;
+                if (v == source || v < 0 || v >= static_cast<int>(level.size()) || parent[v] != u || level[v] < 0 || graph.hasEdge(u, v))
+                    continue;
+                level[v] = PENDING;
+                affected.push_back(v);
+            }
+            for (size_t k = 0; k < affected.size(); ++k) {
+                int u = affected[k];
+                graph.forEachOutEdge(u, [&](int v, const auto&) {
+                    if (parent[v] == u && level[v] >= 0 && v != source) {
+                        level[v] = PENDING;
+                        affected.push_back(v);
+                    }
+                });
+            }
+
+            // Re-level the detached vertices from the in-neighbours that kept their level.
+            for (int v : affected) {
+                parent[v] = -1;
+                graph.forEachInEdge(v, [&](int u) {
+                    if (level[u] >= 0 && level[u] + 1 < ws.tentative[v]) {
+                        ws.tentative[v] = level[u] + 1;
+                        parent[v] = u;
+                    }
+                });
+                if (ws.tentative[v] != INT_MAX)
+                    ws.heap.push({ws.tentative[v], v});
+            }
+            settle(level, parent, ws, true);
+
+            // Re-levelled vertices may have come out lower through inserted edges, so their
+            // out-edges are relaxed again along with the inserted edges.
+            for (int v : affected) {
+                if (level[v] == PENDING) {
+                    level[v] = -1;
+                    parent[v] = -1;
+                } else {
+                    ws.heap.push({level[v], v});
+                }
+                ws.tentative[v] = INT_MAX;
+            }
+
+            // Relax the inserted edges and propagate the decreases.
+            for (const auto& edge : delta.insertions) {
+                int u = edge.first, v = edge.second;
+                if (u < 0 || u >= static_cast<int>(level.size()) || level[u] < 0 || !graph.hasEdge(u, v))
+                    continue;
+                if (level[v] == -1 || level[u] + 1 < level[v]) {
+                    level[v] = level[u] + 1;
+                    parent[v] = u;
+                    ws.heap.push({level[v], v});
+                }
+            }
+            settle(level, parent, ws, false);
+        }
+
+    public:
+        /**
+         * @brief Compute the BFS trees of a set of sources.
+         * @param graph The graph to track; it must outlive this object.
+         * @param sources The source vertices.
+         */
+        IncrementalBFS(const G& graph, const vector<int>& sources) : graph(graph), sources(sources) {
+            recompute();
+        }
+
+        /**
+         * @brief Recompute every BFS tree from scratch.
+         */
+        void recompute() {
+            levels.resize(sources.size());
+            parents.resize(sources.size());
+            for (size_t i = 0; i < sources.size(); ++i)
+                search(sources[i], levels[i], parents[i]);
+        }
+
+        /**
+         * @brief Bring every BFS tree up to date after a delta has been applied to the graph.
+         * Sources are repaired in parallel.
+         * @tparam Delta The type of the delta (anything with insertions and deletions edge lists).
+         * @param delta The delta that was applied to the graph.
+         * @param pool The thread pool to run on.
+         * @return True, or false if validation is enabled and a tree does not match a full search.
+         */
+        template <typename Delta>
+        bool update(const Delta& delta, ThreadPool& pool) {
+            fit(pool.size());
+            parallelFor(pool, 0, sources.size(), [&](int tid, int i) {
+                repair(i, delta, workspaces[tid]);
+            }, 1);
+            return !validating || validate();
+        }
+
+        /**
+         * @brief Bring every BFS tree up to date after a delta, on the calling thread.
+         * @tparam Delta The type of the delta (anything with insertions and deletions edge lists).
+         * @param delta The delta that was applied to the graph.
+         * @return True, or false if validation is enabled and a tree does not match a full search.
+         */
+        template <typename Delta>
+        bool update(const Delta& delta) {
+            ThreadPool pool(1);
+            return update(delta, pool);
+        }
+
+        /**
+         * @brief Update the BFS trees every time a delta is applied.
+         * @tparam Delta The type of the delta (GraphDelta).
+         * @param delta The delta to subscribe to; the subscription must be removed before this object is destroyed.
+         * @return The id of the subscription, for Delta::unsubscribe().
+         */
+        template <typename Delta>
+        int attach(Delta& delta) {
+            return delta.subscribe([this](const Delta& applied) { update(applied); });
+        }
+
+        /**
+         * @brief Enable or disable validation against a full search after every update.
+         * @param enabled Flag indicating if updates should be validated.
+         */
+        void setValidation(bool enabled) {
+            validating = enabled;
+        }
+
+        /**
+         * @brief Compare every BFS tree with a full search from its source.
+         * Levels must match exactly; parents may differ from the full search but must be
+         * in-neighbours one level up. Mismatches are reported on std::cerr.
+         * @return True if every tree is correct, false otherwise.
+         */
+        bool validate() const {
+            bool ok = true;
+            vector<int> level, parent;
+            for (size_t i = 0; i < sources.size(); ++i) {
+                search(sources[i], level, parent);
+                for (int v = 0; v < static_cast<int>(level.size()); ++v) {
+                    int p = parents[i][v];
+                    bool valid = levels[i][v] == level[v] && (level[v] <= 0 ? p == parent[v] :
+                        graph.hasEdge(p, v) && levels[i][p] + 1 == level[v]);
+                    if (!valid) {
+                        std::cerr << "IncrementalBFS mismatch: source " << sources[i] << ", vertex " << v << ", level "
+                                  << levels[i][v] << " (expected " << level[v] << "), parent " << p << std::endl;
+                        ok = false;
+                        break;
+                    }
+                }
+            }
+            return ok;
+        }
+
+        /**
+         * @brief Get the source vertices.
+         */
+        const vector<int>& getSources() const {
+            return sources;
+        }
+
+        /**
+         * @brief Get the levels of the BFS tree of a source.
+         * @param i The index of the source.
+         * @return The level of each vertex, or -1 if it is not reachable.
+         */
+        const vector<int>& getLevels(int i) const {
+            return levels[i];
+        }
+
+        /**
+         * @brief Get the parents of the BFS tree of a source.
+         * @param i The index of the source.
+         * @return The BFS-tree parent of each vertex, the source for itself, or -1 if it is not reachable.
+         */
+        const vector<int>& getParents(int i) const {
+            return parents[i];
+        }
+
+        /**
+         * @brief Get the level of a vertex in the BFS tree of a source.
+         * @param i The index of the source.
+         * @param v The index of the vertex.
+         * @return The level of the vertex, or -1 if it is not reachable.
+         */
+        int getLevel(int i, int v) const {
+            return v >= 0 && v < static_cast<int>(levels[i].size()) ? levels[i][v] : -1;
+        }
+
+        /**
+         * @brief Check if a vertex is reachable from a source.
+         * @param i The index of the source.
+         * @param v The index of the vertex.
+         * @return True if the vertex is reachable, false otherwise.
+         */
+        bool isReachable(int i, int v) const {
+            return getLevel(i, v) >= 0;
+        }
+};
@@ -1,4 +1,4 @@
-#pragma once 
+#pragma once
 
 #include <vector>
 #include <utility>
@@ -6,6 +6,7 @@
 #include <algorithm>
 #include "Graph.hxx"
 #include "utils.hxx"
+#include "sampler.hxx"
 
 using std::vector;
 using std::pair;
@@ -21,12 +22,13 @@ using std::mt19937;
 /**
  * Get a random element from a container.
  * @tparam Container The type of the container.
+ * @tparam RNG The type of the random number generator.
  * @param container The container.
  * @param rng The random number generator.
  * @return A random element from the container.
  */
-template <typename Container>
-auto getRandomElement(Container& container, mt19937& rng) {
+template <typename Container, typename RNG>
+auto getRandomElement(Container& container, RNG& rng) {
     uniform_int_distribution<> dis(0, static_cast<int>(container.size()) - 1);
     auto it = begin(container);
     advance(it, dis(rng));
@@ -34,112 +36,84 @@ auto getRandomElement(Container& container, mt19937& rng) {
 }
 
 /**
- * Get a vector of random existing edges. If count is greater than total edges, all edges are returned.
- * @tparam V The vertex type of the graph.
- * @tparam E The edge type of the graph.
+ * Get a vector of distinct random existing edges, drawn uniformly over all edges. If count is
+ * greater than total edges, all edges are returned.
+ * @tparam G The type of the graph (DiGraph or CSRView).
  * @param graph The directed graph.
  * @param count The number of random edges to retrieve.
  * @param strictDelta strictDelta flag indicating if each insertion/deletion should induce a change to the graph.
+ * @param seed The seed of the random streams.
+ * @param threads The number of threads to use; 0 uses all hardware threads.
  * @return A vector of random existing edges.
  */
-template <typename V, typename E>
-vector<pair<int, int>> getExistingRandomEdges(const DiGraph<V, E>& graph, int count, bool strictDelta) {
-    static random_device rd;
-    static mt19937 rng(rd());
+template <typename G>
+vector<pair<int, int>> getExistingRandomEdges(const G& graph, int count, bool strictDelta, unsigned long long seed = DEFAULT_SEED, int threads = 1) {
+    if (count <= 0)
+        return vector<pair<int, int>>();
     if(count >= graph.getSize()){
         return graph.getAllEdges();
     }
-    vector<pair<int, int>> result;
-    result.reserve(count);
-    auto validVertices = graph.getValidVertices();
-    if (validVertices.empty()) {
-        return result; 
-    }
-    unordered_map<pair<int, int>, bool, PairHash> mp;
-    uniform_int_distribution<> vertexDist(0, static_cast<int>(validVertices.size()) - 1);
-    while (result.size() < count) {
-        int u = validVertices[vertexDist(rng)];
-        auto outEdges = graph.getOutEdges(u);
-        if (!outEdges.empty()) {
-            uniform_int_distribution<> edgeDist(0, static_cast<int>(outEdges.size()) - 1);
-            int v = outEdges[edgeDist(rng)];
-            pair<int, int> edge = make_pair(u, v);
-            if (mp.count(edge)) continue;
-            result.push_back(edge);
-            mp[edge] = true;
-        }
-    }
-    return result;
+    OutEdgeIndex<G> index(graph, count);
+    return sampleEdges(count, true, seed, threads, [&](RandomStream& rng) {
+        return index.edge(rng.uniform(index.size()));
+    });
 }
 
 /**
  * Get a random new edge.
- * @tparam V The vertex type of the graph.
- * @tparam E The edge type of the graph.
- * @param graph The directed graph.
+ * @param vertices The valid vertices of the graph.
+ * @param rng The random stream to draw from.
  * @return A pair of integers representing the new edge.
  */
-template <typename V, typename E>
-std::pair<int, int> getNewRandomEdge(const DiGraph<V, E>& graph) {
-    static random_device rd;
-    static mt19937 rng(rd());
-    auto vertices = graph.getValidVertices();
+inline pair<int, int> getNewRandomEdge(const vector<int>& vertices, RandomStream& rng) {
     if (vertices.empty()) {
-        return {-1, -1}; 
+        return {-1, -1};
     }
-    int u = getRandomElement(vertices, rng);
-    int v = getRandomElement(vertices, rng);
+    int u = vertices[rng.uniform(vertices.size())];
+    int v = vertices[rng.uniform(vertices.size())];
     return {u, v};
 }
 
 /**
  * Get a random edge that doesn't already exist.
- * @tparam V The vertex type of the graph.
- * @tparam E The edge type of the graph.
+ * @tparam G The type of the graph (DiGraph or CSRView).
  * @param graph The directed graph.
+ * @param vertices The valid vertices of the graph.
+ * @param rng The random stream to draw from.
  * @return A pair of integers representing the new edge.
  */
-template <typename V, typename E>
-pair<int, int> getNewRandomEdgeForcibly(const DiGraph<V, E>& graph) {
-    static  random_device rd;
-    static  mt19937 rng(rd());
-    auto vertices = graph.getValidVertices();
-    int u,v;
+template <typename G>
+pair<int, int> getNewRandomEdgeForcibly(const G& graph, const vector<int>& vertices, RandomStream& rng) {
+    pair<int, int> edge;
     do{
-        u = getRandomElement(vertices, rng);
-        v = getRandomElement(vertices, rng);
-    }while (graph.hasEdge(u, v)); 
-    return {u, v};
+        edge = getNewRandomEdge(vertices, rng);
+    }while (graph.hasEdge(edge.first, edge.second));
+    return edge;
 }
 
 /**
  * Get a vector of random new edges.
- * @tparam V The vertex type of the graph.
- * @tparam E The edge type of the graph.
+ * @tparam G The type of the graph (DiGraph or CSRView).
  * @param graph The directed graph.
  * @param count The number of random edges to retrieve.
  * @param strictDelta strictDelta flag indicating if each insertion/deletion should induce a change to the graph.
+ * @param seed The seed of the random streams.
+ * @param threads The number of threads to use; 0 uses all hardware threads.
  * @return A vector of random new edges.
  */
-template <typename V, typename E>
-vector<pair<int, int>> getNewRandomEdges(const DiGraph<V, E>& graph, int count, bool strictDelta) {
-    vector<pair<int, int>> result;
-    unordered_map<pair<int, int>, bool, PairHash> mp;
-    result.reserve(count);
-    int n = graph.getOrder();
-    int m = graph.getSize();
+template <typename G>
+vector<pair<int, int>> getNewRandomEdges(const G& graph, int count, bool strictDelta, unsigned long long seed = DEFAULT_SEED, int threads = 1) {
+    auto vertices = graph.getValidVertices();
+    if (vertices.empty())
+        return vector<pair<int, int>>();
+    long long n = vertices.size();
+    long long m = graph.getSize();
     if(strictDelta){
-        while(result.size() < std::min(count, n*n - m)){
-            pair<int, int> edge = getNewRandomEdgeForcibly(graph);
-            if(mp.count(edge)) continue;
-            result.push_back(edge);
-            mp[edge] = true;
-        }
+        return sampleEdges(std::min<long long>(count, n*n - m), true, seed, threads, [&](RandomStream& rng) {
+            return getNewRandomEdgeForcibly(graph, vertices, rng);
+        });
     }
-    else{
-        for (int i = 0; i < count; ++i) {
-            result.push_back(getNewRandomEdge(graph));
-        }
-    }
-    return result;
-}
\ No newline at end of file
+    return sampleEdges(count, false, seed, threads, [&](RandomStream& rng) {
+        return getNewRandomEdge(vertices, rng);
+    });
+}
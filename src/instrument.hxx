@@ -0,0 +1,116 @@
+#pragma once
+
+/**
+ * Lightweight per-operation counters and timers for DiGraph and GraphDelta.
+ * They are compiled in only when GRAPH_INSTRUMENT is defined; otherwise
+ * INSTRUMENT_SCOPE expands to nothing and costs nothing.
+ */
+
+#ifdef GRAPH_INSTRUMENT
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <ostream>
+
+/**
+ * @class InstrumentCounter
+ * @brief The call count and total time of one instrumented operation.
+ * Counters register themselves in a global list when first constructed.
+ */
+class InstrumentCounter
+{
+    private:
+        static std::mutex& registryMutex() {
+            static std::mutex mutex;
+            return mutex;
+        }
+
+        static std::vector<InstrumentCounter*>& registry() {
+            static std::vector<InstrumentCounter*> counters;
+            return counters;
+        }
+
+    public:
+        const char* name;
+        std::atomic<unsigned long long> calls{0};
+        std::atomic<unsigned long long> nanoseconds{0};
+
+        explicit InstrumentCounter(const char* name) : name(name) {
+            std::lock_guard<std::mutex> lock(registryMutex());
+            registry().push_back(this);
+        }
+
+        /**
+         * @brief Reset every registered counter to zero.
+         */
+        static void resetAll() {
+            std::lock_guard<std::mutex> lock(registryMutex());
+            for (auto* counter : registry()) {
+                counter->calls = 0;
+                counter->nanoseconds = 0;
+            }
+        }
+
+        /**
+         * @brief Write the totals of every registered counter as a JSON object keyed by operation name.
+         * Counters of different template instantiations with the same name are summed.
+         * @param os The output stream.
+         */
+        static void reportJson(std::ostream& os) {
+            std::map<std::string, std::pair<unsigned long long, unsigned long long>> totals;
+            {
+                std::lock_guard<std::mutex> lock(registryMutex());
+                for (auto* counter : registry()) {
+                    auto& total = totals[counter->name];
+                    total.first += counter->calls;
+                    total.second += counter->nanoseconds;
+                }
+            }
+            os << "{";
+            bool first = true;
+            for (const auto& entry : totals) {
+                if (entry.second.first == 0)
+                    continue;
+                os << (first ? "" : ", ") << "\"" << entry.first << "\": {\"calls\": " << entry.second.first
+                   << ", \"ns\": " << entry.second.second << "}";
+                first = false;
+            }
+            os << "}";
+        }
+};
+
+/**
+ * @class InstrumentTimer
+ * @brief Adds one call and the time until destruction to a counter.
+ */
+class InstrumentTimer
+{
+    private:
+        InstrumentCounter& counter;
+        std::chrono::steady_clock::time_point start;
+
+    public:
+        explicit InstrumentTimer(InstrumentCounter& counter) : counter(counter), start(std::chrono::steady_clock::now()) {}
+
+        ~InstrumentTimer() {
+            auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+            counter.calls.fetch_add(1, std::memory_order_relaxed);
+            counter.nanoseconds.fetch_add(elapsed, std::memory_order_relaxed);
+        }
+};
+
+#define INSTRUMENT_CONCAT_(a, b) a##b
+#define INSTRUMENT_CONCAT(a, b) INSTRUMENT_CONCAT_(a, b)
+#define INSTRUMENT_SCOPE(name) \
+    static InstrumentCounter INSTRUMENT_CONCAT(instrumentCounter_, __LINE__)(name); \
+    InstrumentTimer INSTRUMENT_CONCAT(instrumentTimer_, __LINE__)(INSTRUMENT_CONCAT(instrumentCounter_, __LINE__))
+
+#else
+
+#define INSTRUMENT_SCOPE(name) do {} while (0)
+
+#endif
@@ -2,39 +2,483 @@
 
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <vector>
 #include <string>
+#include <cstring>
+#include <cctype>
+#include <climits>
+#include <algorithm>
+#include <type_traits>
 #include <filesystem>
 #include "Graph.hxx"
+#include "mmap.hxx"
+#include "parallel.hxx"
+
+/**
+ * @struct MtxHeader
+ * @brief The qualifiers and dimensions declared by a Matrix Market file.
+ */
+struct MtxHeader {
+    /** True if entries carry no value (pattern field). */
+    bool pattern = true;
+    /** True if only one triangle is stored (symmetric, skew-symmetric or hermitian). */
+    bool symmetric = false;
+    /** True if mirrored entries take the negated value (skew-symmetric). */
+    bool skew = false;
+    int rows = 0, cols = 0;
+    long long entries = 0;
+};
+
+/**
+ * @brief Skips spaces and tabs.
+ * @param p The current position, advanced past the blanks.
+ * @param end The end of the buffer.
+ */
+inline void mtxSkipBlanks(const char*& p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+        ++p;
+}
+
+/**
+ * @brief Skips to the start of the next line.
+ * @param p The current position, advanced past the next newline.
+ * @param end The end of the buffer.
+ */
+inline void mtxSkipLine(const char*& p, const char* end) {
+    const char* newline = static_cast<const char*>(memchr(p, '\n', end - p));
+    p = newline ? newline + 1 : end;
+}
+
+/**
+ * @brief Parses a non-negative decimal integer.
+ * @param p The current position, advanced past the number.
+ * @param end The end of the buffer.
+ * @param value Set to the parsed number.
+ * @return True if at least one digit was read, false otherwise.
+ */
+inline bool mtxParseInt(const char*& p, const char* end, long long& value) {
+    mtxSkipBlanks(p, end);
+    const char* start = p;
+    value = 0;
+    while (p < end && *p >= '0' && *p <= '9')
+        value = value * 10 + (*p++ - '0');
+    return p != start;
+}
+
+/**
+ * @brief Parses a decimal floating-point number with optional sign, fraction and exponent.
+ * @param p The current position, advanced past the number.
+ * @param end The end of the buffer.
+ * @param value Set to the parsed number.
+ * @return True if at least one digit was read, false otherwise.
+ */
+inline bool mtxParseReal(const char*& p, const char* end, double& value) {
+    mtxSkipBlanks(p, end);
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+'))
+        negative = *p++ == '-';
+    const char* start = p;
+    double mantissa = 0;
+    int exponent = 0;
+    while (p < end && *p >= '0' && *p <= '9')
+        mantissa = mantissa * 10 + (*p++ - '0');
+    if (p < end && *p == '.') {
+        ++p;
+        while (p < end && *p >= '0' && *p <= '9') {
+            mantissa = mantissa * 10 + (*p++ - '0');
+            --exponent;
+        }
+    }
+    if (p == start)
+        return false;
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        ++p;
+        bool negativeExponent = false;
+        if (p < end && (*p == '-' || *p == '+'))
+            negativeExponent = *p++ == '-';
+        int e = 0;
+        while (p < end && *p >= '0' && *p <= '9')
+            e = e * 10 + (*p++ - '0');
+        exponent += negativeExponent ? -e : e;
+    }
+    double scale = 1;
+    for (int e = exponent < 0 ? -exponent : exponent; e > 0; --e)
+        scale *= 10;
+    value = exponent < 0 ? mantissa / scale : mantissa * scale;
+    if (negative)
+        value = -value;
+    return true;
+}
+
+/**
+ * @brief Parses the banner, comments and size line of a Matrix Market file.
+ * A file without a %%MatrixMarket banner is read as a general pattern matrix.
+ * @param p The start of the file, advanced to the first entry line.
+ * @param end The end of the buffer.
+ * @param header Set to the declared qualifiers and dimensions.
+ * @return True if the header was understood, false otherwise.
+ */
+inline bool parseMtxHeader(const char*& p, const char* end, MtxHeader& header) {
+    const char banner[] = "%%MatrixMarket";
+    size_t bannerLength = sizeof(banner) - 1;
+    if (static_cast<size_t>(end - p) >= bannerLength && memcmp(p, banner, bannerLength) == 0) {
+        const char* lineEnd = static_cast<const char*>(memchr(p, '\n', end - p));
+        std::string line(p, lineEnd ? lineEnd : end);
+        for (char& c : line)
+            c = tolower(c);
+        std::istringstream iss(line.substr(bannerLength));
+        std::string object, format, field, symmetry;
+        iss >> object >> format >> field >> symmetry;
+        if (object != "matrix" || format != "coordinate" || field == "complex")
+            return false;
+        header.pattern = field == "pattern";
+        header.symmetric = symmetry == "symmetric" || symmetry == "skew-symmetric" || symmetry == "hermitian";
+        header.skew = symmetry == "skew-symmetric";
+        mtxSkipLine(p, end);
+    }
+    while (p < end) {
+        mtxSkipBlanks(p, end);
+        if (p < end && (*p == '%' || *p == '\n')) {
+            mtxSkipLine(p, end);
+            continue;
+        }
+        long long rows, cols, entries;
+        if (!mtxParseInt(p, end, rows) || !mtxParseInt(p, end, cols) || !mtxParseInt(p, end, entries) ||
+            rows < 0 || cols < 0 || rows > INT_MAX || cols > INT_MAX || entries < 0)
+            return false;
+        header.rows = rows;
+        header.cols = cols;
+        header.entries = entries;
+        mtxSkipLine(p, end);
+        return true;
+    }
+    return false;
+}
 
 /**
  * @brief Loads a directed graph from a file in the Matrix Market (.mtx) format.
+ * The file is memory-mapped and its entry lines are parsed in parallel chunks. Symmetric
+ * files get both directions of each off-diagonal entry, and weighted (real/integer) files
+ * store the entry value as the edge data; pattern files use the default edge data.
+ * @tparam V The type of data stored in each vertex.
+ * @tparam E The type of data stored in each edge.
+ * @tparam A The adjacency policy of the graph.
  * @param fileName The name of the file to load the graph from.
- * @return The loaded graph.
+ * @param graph Set to the loaded graph.
+ * @param threads The number of threads to use; 0 uses all hardware threads.
+ * @return True if the file was read, false if it could not be opened or its header is invalid.
  */
-DiGraph<int, int> loadMtxGraphFromFile(const std::string& fileName) {
-    DiGraph<int,int> graph;
-    std::ifstream file(fileName);
-    if (!file.is_open()) {
+template <typename V, typename E, typename A>
+bool readMtxGraph(const std::string& fileName, DiGraph<V, E, A>& graph, int threads = 0) {
+    graph.clear();
+    MappedFile file;
+    if (!file.open(fileName)) {
         std::cerr << "Failed to open file: " << fileName << std::endl;
-        return graph;
+        return false;
+    }
+    const char* p = file.data();
+    const char* end = p + file.size();
+    MtxHeader header;
+    if (!p || !parseMtxHeader(p, end, header)) {
+        std::cerr << "Invalid Matrix Market header: " << fileName << std::endl;
+        return false;
     }
-    int numVertices, numEdges;
-    std::string line;
-    getline(file, line);
-    while (getline(file, line) && line[0] == '%') {}
-    std::istringstream iss(line);
-    iss >> numVertices >> numVertices >> numEdges;
+    int numVertices = std::max(header.rows, header.cols);
     for (int i = 0; i < numVertices; ++i) {
         graph.addVertex(i);
     }
-    while (getline(file, line)) {
-        std::istringstream iss(line);
-        int u, v;
-        iss >> u >> v;
-        graph.addEdge(u - 1, v - 1); // Adjust indices since MTX format is 1-based
+
+    ThreadPool pool(threads);
+    int numChunks = pool.size() * 4;
+    vector<vector<pair<int, int>>> chunkEdges(numChunks);
+    vector<vector<E>> chunkData(numChunks);
+    const char* body = p;
+    parallelFor(pool, 0, numChunks, [&](int, int c) {
+        const char* q = body + (end - body) * c / numChunks;
+        const char* stop = body + (end - body) * (c + 1) / numChunks;
+        if (c > 0 && q[-1] != '\n')
+            mtxSkipLine(q, end);
+        auto& edges = chunkEdges[c];
+        auto& data = chunkData[c];
+        if (q < stop)
+            edges.reserve((stop - q) / 8 * (header.symmetric ? 2 : 1));
+        while (q < stop) {
+            long long u, v;
+            double value = 0;
+            mtxSkipBlanks(q, end);
+            if (q >= end || *q == '%' || *q == '\n' || !mtxParseInt(q, end, u) || !mtxParseInt(q, end, v)) {
+                mtxSkipLine(q, end);
+                continue;
+            }
+            if (!header.pattern)
+                mtxParseReal(q, end, value);
+            mtxSkipLine(q, end);
+            // Adjust indices since MTX format is 1-based
+            edges.push_back({static_cast<int>(u - 1), static_cast<int>(v - 1)});
+            if (header.symmetric && u != v)
+                edges.push_back({static_cast<int>(v - 1), static_cast<int>(u - 1)});
+            if constexpr (std::is_arithmetic<E>::value) {
+                if (!header.pattern) {
+                    data.push_back(static_cast<E>(value));
+                    if (header.symmetric && u != v)
+                        data.push_back(static_cast<E>(header.skew ? -value : value));
+                }
+            }
+        }
+    }, 1);
+
+    size_t total = 0;
+    for (const auto& edges : chunkEdges)
+        total += edges.size();
+    vector<pair<int, int>> edges;
+    vector<E> data;
+    edges.reserve(total);
+    if (!header.pattern)
+        data.reserve(total);
+    for (int c = 0; c < numChunks; ++c) {
+        edges.insert(edges.end(), chunkEdges[c].begin(), chunkEdges[c].end());
+        data.insert(data.end(), chunkData[c].begin(), chunkData[c].end());
+        vector<pair<int, int>>().swap(chunkEdges[c]);
+        vector<E>().swap(chunkData[c]);
+    }
+    graph.addEdges(edges, data, pool);
+    return true;
+}
+
+/**
+ * @brief Loads a directed graph from a file in the Matrix Market (.mtx) format.
+ * @tparam V The type of data stored in each vertex.
+ * @tparam E The type of data stored in each edge.
+ * @tparam A The adjacency policy of the graph.
+ * @param fileName The name of the file to load the graph from.
+ * @param threads The number of threads to use; 0 uses all hardware threads.
+ * @return The loaded graph, or an empty graph if the file could not be read.
+ */
+template <typename V = int, typename E = int, typename A = HashPolicy>
+DiGraph<V, E, A> loadMtxGraphFromFile(const std::string& fileName, int threads = 0) {
+    DiGraph<V, E, A> graph;
+    readMtxGraph(fileName, graph, threads);
+    return graph;
+}
+
+/**
+ * @struct BinaryGraphHeader
+ * @brief The header of the binary graph format written by saveBinaryGraph().
+ * It is followed by the validity flags, the vertex data, the row offsets,
+ * the edge targets and the edge data, each padded to a multiple of 8 bytes.
+ */
+struct BinaryGraphHeader {
+    char magic[8];
+    unsigned int version;
+    unsigned int vertexDataSize;
+    unsigned int edgeDataSize;
+    /** The kinds of the vertex and edge data, from binaryDataKind(). */
+    unsigned int vertexDataKind;
+    unsigned int edgeDataKind;
+    unsigned int reserved;
+    unsigned long long span;
+    unsigned long long edges;
+};
+
+const char BINARY_GRAPH_MAGIC[8] = {'N', 'G', 'G', 'R', 'A', 'P', 'H', '\0'};
+const unsigned int BINARY_GRAPH_VERSION = 2;
+
+/**
+ * @brief Gets the kind of a data type stored in the binary graph format.
+ * Together with the size it keeps a file written for one type from being read as another.
+ * @tparam T The data type.
+ * @return 1 for signed integers, 2 for unsigned integers (and bool), 3 for floating point, 0 otherwise.
+ */
+template <typename T>
+unsigned int binaryDataKind() {
+    if (std::is_floating_point<T>::value)
+        return 3;
+    if (std::is_integral<T>::value)
+        return std::is_signed<T>::value ? 1 : 2;
+    return 0;
+}
+
+/**
+ * @brief Rounds a byte count up to a multiple of 8.
+ * @param bytes The byte count.
+ * @return The padded byte count.
+ */
+inline size_t binaryGraphPad(size_t bytes) {
+    return (bytes + 7) & ~static_cast<size_t>(7);
+}
+
+/**
+ * @brief Saves a directed graph in the binary graph format.
+ * @tparam V The type of data stored in each vertex (must be trivially copyable).
+ * @tparam E The type of data stored in each edge (must be trivially copyable).
+ * @param graph The graph to save.
+ * @param fileName The name of the file to write.
+ * @return True if the file was written, false otherwise.
+ */
+template <typename V, typename E, typename A>
+bool saveBinaryGraph(const DiGraph<V, E, A>& graph, const std::string& fileName) {
+    static_assert(std::is_trivially_copyable<V>::value && std::is_trivially_copyable<E>::value,
+                  "binary graph format needs trivially copyable vertex and edge data");
+    std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open file: " << fileName << std::endl;
+        return false;
+    }
+    unsigned long long n = graph.getSpan();
+    vector<char> valid(binaryGraphPad(n), 0);
+    vector<V> vertexData(n);
+    vector<unsigned long long> offsets(n + 1, 0);
+    vector<int> targets;
+    vector<E> edgeData;
+    targets.reserve(graph.getSize());
+    edgeData.reserve(graph.getSize());
+    for (unsigned long long u = 0; u < n; ++u) {
+        valid[u] = graph.hasVertex(u);
+        vertexData[u] = graph.getVertexData(u);
+        graph.forEachOutEdge(u, [&](int v, const E& data) {
+            targets.push_back(v);
+            edgeData.push_back(data);
+        });
+        offsets[u + 1] = targets.size();
+    }
+
+    BinaryGraphHeader header = {};
+    memcpy(header.magic, BINARY_GRAPH_MAGIC, sizeof(header.magic));
+    header.version = BINARY_GRAPH_VERSION;
+    header.vertexDataSize = sizeof(V);
+    header.edgeDataSize = sizeof(E);
+    header.vertexDataKind = binaryDataKind<V>();
+    header.edgeDataKind = binaryDataKind<E>();
+    header.span = n;
+    header.edges = targets.size();
+    const char zeros[8] = {};
+    auto writePadded = [&](const void* bytes, size_t length) {
+        file.write(static_cast<const char*>(bytes), length);
+        file.write(zeros, binaryGraphPad(length) - length);
+    };
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    writePadded(valid.data(), valid.size());
+    writePadded(vertexData.data(), n * sizeof(V));
+    writePadded(offsets.data(), (n + 1) * sizeof(unsigned long long));
+    writePadded(targets.data(), targets.size() * sizeof(int));
+    writePadded(edgeData.data(), edgeData.size() * sizeof(E));
+    return static_cast<bool>(file);
+}
+
+/**
+ * @brief Reads a directed graph in the binary graph format through a memory mapping.
+ * @tparam V The type of data stored in each vertex.
+ * @tparam E The type of data stored in each edge.
+ * @tparam A The adjacency policy of the graph.
+ * @param fileName The name of the file to read.
+ * @param graph Set to the loaded graph.
+ * @param threads The number of threads to use; 0 uses all hardware threads.
+ * @return True if the file is a valid graph for these vertex and edge types, false otherwise.
+ */
+template <typename V, typename E, typename A>
+bool readBinaryGraph(const std::string& fileName, DiGraph<V, E, A>& graph, int threads = 0) {
+    static_assert(std::is_trivially_copyable<V>::value && std::is_trivially_copyable<E>::value,
+                  "binary graph format needs trivially copyable vertex and edge data");
+    graph.clear();
+    MappedFile file;
+    if (!file.open(fileName) || file.size() < sizeof(BinaryGraphHeader))
+        return false;
+    BinaryGraphHeader header;
+    memcpy(&header, file.data(), sizeof(header));
+    if (memcmp(header.magic, BINARY_GRAPH_MAGIC, sizeof(header.magic)) != 0 || header.version != BINARY_GRAPH_VERSION ||
+        header.vertexDataSize != sizeof(V) || header.edgeDataSize != sizeof(E) ||
+        header.vertexDataKind != binaryDataKind<V>() || header.edgeDataKind != binaryDataKind<E>())
+        return false;
+    unsigned long long n = header.span, m = header.edges;
+    // Vertex indices and edge counts are ints, and no section can be larger than the file;
+    // checking by division keeps the section sizes below from overflowing.
+    size_t bytes = file.size();
+    if (n > static_cast<unsigned long long>(INT_MAX) || m > static_cast<unsigned long long>(INT_MAX) ||
+        n > bytes || n > bytes / sizeof(V) || n + 1 > bytes / sizeof(unsigned long long) ||
+        m > bytes / sizeof(int) || m > bytes / sizeof(E))
+        return false;
+    size_t validAt = sizeof(header);
+    size_t vertexAt = validAt + binaryGraphPad(n);
+    size_t offsetAt = vertexAt + binaryGraphPad(n * sizeof(V));
+    size_t targetAt = offsetAt + binaryGraphPad((n + 1) * sizeof(unsigned long long));
+    size_t edgeAt = targetAt + binaryGraphPad(m * sizeof(int));
+    if (bytes < edgeAt + binaryGraphPad(m * sizeof(E)))
+        return false;
+    const char* valid = file.data() + validAt;
+    const unsigned long long* offsets = reinterpret_cast<const unsigned long long*>(file.data() + offsetAt);
+    const int* targets = reinterpret_cast<const int*>(file.data() + targetAt);
+    if (offsets[0] != 0 || offsets[n] != m)
+        return false;
+    for (unsigned long long u = 0; u < n; ++u) {
+        if (offsets[u] > offsets[u + 1])
+            return false;
     }
-    file.close();
+
+    for (unsigned long long u = 0; u < n; ++u) {
+        V data;
+        memcpy(&data, file.data() + vertexAt + u * sizeof(V), sizeof(V));
+        graph.addVertex(data);
+    }
+    vector<pair<int, int>> edges(m);
+    vector<E> edgeData(m);
+    for (unsigned long long u = 0; u < n; ++u) {
+        for (unsigned long long i = offsets[u]; i < offsets[u + 1]; ++i)
+            edges[i] = {static_cast<int>(u), targets[i]};
+    }
+    if (m > 0)
+        memcpy(edgeData.data(), file.data() + edgeAt, m * sizeof(E));
+    ThreadPool pool(threads);
+    graph.addEdges(edges, edgeData, pool);
+    for (unsigned long long u = 0; u < n; ++u) {
+        if (!valid[u])
+            graph.removeVertex(u);
+    }
+    return true;
+}
+
+/**
+ * @brief Loads a directed graph from a file in the binary graph format.
+ * @tparam V The type of data stored in each vertex.
+ * @tparam E The type of data stored in each edge.
+ * @tparam A The adjacency policy of the graph.
+ * @param fileName The name of the file to load the graph from.
+ * @param threads The number of threads to use; 0 uses all hardware threads.
+ * @return The loaded graph, or an empty graph if the file could not be read.
+ */
+template <typename V = int, typename E = int, typename A = HashPolicy>
+DiGraph<V, E, A> loadBinaryGraph(const std::string& fileName, int threads = 0) {
+    DiGraph<V, E, A> graph;
+    if (!readBinaryGraph(fileName, graph, threads))
+        std::cerr << "Failed to read binary graph: " << fileName << std::endl;
+    return graph;
+}
+
+/**
+ * @brief Loads a Matrix Market graph through a binary cache.
+ * If the cache exists and is at least as new as the Matrix Market file it is mapped
+ * directly; otherwise the Matrix Market file is parsed and, if that succeeds, the cache is (re)written.
+ * @tparam V The type of data stored in each vertex.
+ * @tparam E The type of data stored in each edge.
+ * @tparam A The adjacency policy of the graph.
+ * @param fileName The name of the Matrix Market file.
+ * @param cacheName The name of the cache file; empty uses fileName + ".bin".
+ * @param threads The number of threads to use; 0 uses all hardware threads.
+ * @return The loaded graph, or an empty graph if neither file could be read.
+ */
+template <typename V = int, typename E = int, typename A = HashPolicy>
+DiGraph<V, E, A> loadMtxGraphCached(const std::string& fileName, std::string cacheName = "", int threads = 0) {
+    namespace fs = std::filesystem;
+    if (cacheName.empty())
+        cacheName = fileName + ".bin";
+    std::error_code error;
+    DiGraph<V, E, A> graph;
+    if (fs::exists(cacheName, error) && fs::last_write_time(cacheName, error) >= fs::last_write_time(fileName, error) &&
+        readBinaryGraph(cacheName, graph, threads))
+        return graph;
+    // A file that cannot be parsed must not leave an empty cache behind that looks up to date.
+    if (readMtxGraph(fileName, graph, threads))
+        saveBinaryGraph(graph, cacheName);
     return graph;
 }
 
@@ -44,14 +488,16 @@ DiGraph<int, int> loadMtxGraphFromFile(const std::string& fileName) {
  * @param argv The array of command line arguments.
  * @return The loaded graph or an empty graph if the file has an invalid extension.
  */
-template <typename V, typename E>
-DiGraph<V, E> handleFile(int argc, char* argv[]) {
+template <typename V, typename E, typename A = HashPolicy>
+DiGraph<V, E, A> handleFile(int argc, char* argv[]) {
     std::string filename = argv[1];
     std::filesystem::path filePath(filename);
     if (filePath.extension() == ".mtx") {
-        return loadMtxGraphFromFile(filePath);
+        return loadMtxGraphFromFile<V, E, A>(filePath);
+    } else if (filePath.extension() == ".bin") {
+        return loadBinaryGraph<V, E, A>(filePath);
     } else {
-        std::cout << "Invalid file extension. Expected .mtx file.\n";
-        return DiGraph<V, E>();
+        std::cout << "Invalid file extension. Expected .mtx or .bin file.\n";
+        return DiGraph<V, E, A>();
     }
 }
@@ -5,11 +5,20 @@
 #include <sstream>
 #include <string>
 
-// #include "AVLTree.hxx"
 #include "bfs.hxx"
 #include "timer.hxx"
+#include "adjacency.hxx"
 #include "Graph.hxx"
-#include "Delta.hxx"
+#include "csr.hxx"
+#include "delta.hxx"
 #include "utils.hxx"
+#include "sampler.hxx"
+#include "mmap.hxx"
+#include "parallel.hxx"
 #include "edge.hxx"
 #include "loader.hxx"
+#include "sequence.hxx"
+#include "instrument.hxx"
+#include "synthetic.hxx"
+#include "benchmark.hxx"
+#include "dynbfs.hxx"
@@ -0,0 +1,108 @@
+#pragma once
+#include <string>
+#include <cstddef>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @class MappedFile
+ * @brief A read-only memory mapping of a whole file, unmapped on destruction.
+ */
+class MappedFile
+{
+    private:
+        const char* bytes = nullptr;
+        size_t length = 0;
+
+    public:
+        MappedFile() = default;
+
+        /**
+         * @brief Map a file into memory.
+         * @param fileName The name of the file to map.
+         */
+        explicit MappedFile(const std::string& fileName) {
+            open(fileName);
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        MappedFile(MappedFile&& other) noexcept : bytes(other.bytes), length(other.length) {
+            other.bytes = nullptr;
+            other.length = 0;
+        }
+
+        MappedFile& operator=(MappedFile&& other) noexcept {
+            if (this != &other) {
+                close();
+                bytes = other.bytes;
+                length = other.length;
+                other.bytes = nullptr;
+                other.length = 0;
+            }
+            return *this;
+        }
+
+        ~MappedFile() {
+            close();
+        }
+
+        /**
+         * @brief Map a file into memory, replacing any current mapping.
+         * @param fileName The name of the file to map.
+         * @return True if the file was mapped (an empty file maps to an empty range), false otherwise.
+         */
+        bool open(const std::string& fileName) {
+            close();
+            int fd = ::open(fileName.c_str(), O_RDONLY);
+            if (fd < 0)
+                return false;
+            struct stat info;
+            if (fstat(fd, &info) != 0) {
+                ::close(fd);
+                return false;
+            }
+            length = info.st_size;
+            if (length > 0) {
+                void* address = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (address == MAP_FAILED) {
+                    ::close(fd);
+                    length = 0;
+                    return false;
+                }
+                madvise(address, length, MADV_SEQUENTIAL);
+                bytes = static_cast<const char*>(address);
+            }
+            ::close(fd);
+            return true;
+        }
+
+        /**
+         * @brief Unmap the file, if any.
+         */
+        void close() {
+            if (bytes)
+                munmap(const_cast<char*>(bytes), length);
+            bytes = nullptr;
+            length = 0;
+        }
+
+        /**
+         * @brief Get the first byte of the mapping.
+         * @return A pointer to the mapped bytes, or nullptr if nothing is mapped.
+         */
+        const char* data() const {
+            return bytes;
+        }
+
+        /**
+         * @brief Get the length of the mapping.
+         * @return The number of mapped bytes.
+         */
+        size_t size() const {
+            return length;
+        }
+};
@@ -0,0 +1,131 @@
+#pragma once
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <algorithm>
+
+/**
+ * @class ThreadPool
+ * @brief A fixed set of worker threads that run the same task together.
+ * The calling thread takes part as thread 0, so a pool of size 1 runs
+ * everything inline without any synchronisation.
+ */
+class ThreadPool
+{
+    private:
+        std::vector<std::thread> workers;
+        std::mutex mutex;
+        std::condition_variable wake, done;
+        std::function<void(int)> task;
+        unsigned long long generation = 0;
+        int pending = 0;
+        bool stopping = false;
+
+        /**
+         * @brief The loop run by each worker thread.
+         * @param tid The index of the worker thread.
+         */
+        void workerLoop(int tid) {
+            unsigned long long seen = 0;
+            while (true) {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&]() { return stopping || generation != seen; });
+                if (stopping)
+                    return;
+                seen = generation;
+                lock.unlock();
+                task(tid);
+                lock.lock();
+                if (--pending == 0)
+                    done.notify_one();
+            }
+        }
+
+    public:
+        /**
+         * @brief Start a pool with the given number of threads.
+         * @param threads The number of threads, including the caller; 0 uses all hardware threads.
+         */
+        explicit ThreadPool(int threads = 0) {
+            if (threads <= 0)
+                threads = std::max(1u, std::thread::hardware_concurrency());
+            for (int tid = 1; tid < threads; ++tid)
+                workers.emplace_back(&ThreadPool::workerLoop, this, tid);
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        ~ThreadPool() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            wake.notify_all();
+            for (auto& worker : workers)
+                worker.join();
+        }
+
+        /**
+         * @brief Get the number of threads in the pool, including the caller.
+         * @return The number of threads.
+         */
+        int size() const {
+            return workers.size() + 1;
+        }
+
+        /**
+         * @brief Run a task on every thread of the pool and wait for all of them to finish.
+         * @param fn The task to run as fn(tid), with tid in [0, size()).
+         */
+        void run(const std::function<void(int)>& fn) {
+            if (workers.empty()) {
+                fn(0);
+                return;
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                task = fn;
+                pending = workers.size();
+                generation++;
+            }
+            wake.notify_all();
+            fn(0);
+            std::unique_lock<std::mutex> lock(mutex);
+            done.wait(lock, [&]() { return pending == 0; });
+        }
+};
+
+/**
+ * @brief Runs a loop body over an index range on all threads of a pool, handing out chunks dynamically.
+ * @tparam Function The type of the loop body.
+ * @param pool The thread pool to run on.
+ * @param begin The first index of the range.
+ * @param end One past the last index of the range.
+ * @param fn The loop body, called as fn(tid, i) for each index.
+ * @param chunk The number of consecutive indices handed to a thread at a time.
+ */
+template <typename Function>
+void parallelFor(ThreadPool& pool, int begin, int end, Function&& fn, int chunk = 1024) {
+    if (begin >= end)
+        return;
+    if (pool.size() == 1 || end - begin <= chunk) {
+        for (int i = begin; i < end; ++i)
+            fn(0, i);
+        return;
+    }
+    std::atomic<int> next(begin);
+    pool.run([&](int tid) {
+        while (true) {
+            int first = next.fetch_add(chunk, std::memory_order_relaxed);
+            if (first >= end)
+                break;
+            int last = std::min(end, first + chunk);
+            for (int i = first; i < last; ++i)
+                fn(tid, i);
+        }
+    });
+}
@@ -0,0 +1,465 @@
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <limits>
+#include <algorithm>
+#include <type_traits>
+#include <cmath>
+#include "parallel.hxx"
+
+using std::vector;
+using std::pair;
+
+/**
+ * @brief The seed used by generators that are not given one explicitly.
+ */
+const unsigned long long DEFAULT_SEED = 0x6a09e667f3bcc908ULL;
+
+/**
+ * @brief Advances a SplitMix64 state and returns the next output.
+ * @param state The generator state.
+ * @return A well-mixed 64-bit value.
+ */
+inline unsigned long long splitMix64(unsigned long long& state) {
+    unsigned long long z = (state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+/**
+ * @class RandomStream
+ * @brief A small, fast xoshiro256** generator usable as a standard uniform random bit generator.
+ * Independent streams are obtained by deriving a seed per stream with derive().
+ */
+class RandomStream
+{
+    private:
+        unsigned long long s[4];
+
+        static unsigned long long rotl(unsigned long long x, int k) {
+            return (x << k) | (x >> (64 - k));
+        }
+
+    public:
+        using result_type = unsigned long long;
+
+        /**
+         * @brief Create a stream from a seed.
+         * @param seed The seed of the stream.
+         */
+        explicit RandomStream(unsigned long long seed = DEFAULT_SEED) {
+            for (auto& word : s)
+                word = splitMix64(seed);
+        }
+
+        /**
+         * @brief Derive the seed of an independent sub-stream.
+         * @param seed The parent seed.
+         * @param stream The index of the sub-stream.
+         * @return The seed of the sub-stream.
+         */
+        static unsigned long long derive(unsigned long long seed, unsigned long long stream) {
+            unsigned long long state = seed ^ (stream * 0xd1b54a32d192ed03ULL);
+            splitMix64(state);
+            return splitMix64(state);
+        }
+
+        static constexpr result_type min() { return 0; }
+        static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+        result_type operator()() {
+            unsigned long long result = rotl(s[1] * 5, 7) * 9;
+            unsigned long long t = s[1] << 17;
+            s[2] ^= s[0];
+            s[3] ^= s[1];
+            s[1] ^= s[2];
+            s[0] ^= s[3];
+            s[2] ^= t;
+            s[3] = rotl(s[3], 45);
+            return result;
+        }
+
+        /**
+         * @brief Draw a uniform integer in [0, bound) with Lemire's multiply-shift method.
+         * @param bound The exclusive upper bound (must be positive).
+         * @return The drawn integer.
+         */
+        unsigned long long uniform(unsigned long long bound) {
+            unsigned __int128 product = static_cast<unsigned __int128>((*this)()) * bound;
+            unsigned long long low = static_cast<unsigned long long>(product);
+            if (low < bound) {
+                unsigned long long threshold = -bound % bound;
+                while (low < threshold) {
+                    product = static_cast<unsigned __int128>((*this)()) * bound;
+                    low = static_cast<unsigned long long>(product);
+                }
+            }
+            return static_cast<unsigned long long>(product >> 64);
+        }
+
+        /**
+         * @brief Draw a uniform real number in [0, 1).
+         * @return The drawn number.
+         */
+        double uniformReal() {
+            return ((*this)() >> 11) * 0x1.0p-53;
+        }
+};
+
+/**
+ * @class AliasTable
+ * @brief Samples indices in proportion to fixed weights in O(1) time (Vose's alias method).
+ */
+class AliasTable
+{
+    private:
+        vector<double> probability;
+        vector<int> alias;
+
+    public:
+        AliasTable() = default;
+
+        /**
+         * @brief Build a table from non-negative weights. If all weights are zero, indices are drawn uniformly.
+         * @param weights The weight of each index.
+         */
+        explicit AliasTable(const vector<double>& weights) {
+            int n = weights.size();
+            probability.assign(n, 1.0);
+            alias.resize(n);
+            double total = 0;
+            for (double w : weights)
+                total += w;
+            if (n == 0 || total <= 0) {
+                for (int i = 0; i < n; ++i)
+                    alias[i] = i;
+                return;
+            }
+            vector<double> scaled(n);
+            vector<int> small, large;
+            for (int i = 0; i < n; ++i) {
+                scaled[i] = weights[i] * n / total;
+                alias[i] = i;
+                (scaled[i] < 1.0 ? small : large).push_back(i);
+            }
+            while (!small.empty() && !large.empty()) {
+                int s = small.back(), l = large.back();
+                small.pop_back();
+                probability[s] = scaled[s];
+                alias[s] = l;
+                scaled[l] -= 1.0 - scaled[s];
+                if (scaled[l] < 1.0) {
+                    large.pop_back();
+                    small.push_back(l);
+                }
+            }
+        }
+
+        /**
+         * @brief Get the number of indices in the table.
+         * @return The number of indices.
+         */
+        int size() const {
+            return probability.size();
+        }
+
+        /**
+         * @brief Draw an index.
+         * @param rng The random stream to draw from.
+         * @return An index in [0, size()), drawn in proportion to its weight.
+         */
+        int sample(RandomStream& rng) const {
+            int i = rng.uniform(probability.size());
+            return rng.uniformReal() < probability[i] ? i : alias[i];
+        }
+};
+
+/**
+ * @brief Packs a directed edge into a single 64-bit key.
+ * @param u The source vertex.
+ * @param v The target vertex.
+ * @return The packed key.
+ */
+inline unsigned long long packEdge(int u, int v) {
+    return (static_cast<unsigned long long>(static_cast<unsigned int>(u)) << 32) | static_cast<unsigned int>(v);
+}
+
+/**
+ * @class EdgeKeySet
+ * @brief An open-addressing (linear probing) hash set of packed edge keys.
+ */
+class EdgeKeySet
+{
+    private:
+        static constexpr unsigned long long EMPTY = ~0ULL;
+        vector<unsigned long long> slots;
+        size_t count = 0;
+        int shift = 64;
+
+        size_t slotOf(unsigned long long key) const {
+            return (key * 0x9e3779b97f4a7c15ULL) >> shift;
+        }
+
+        void rehash(size_t capacity) {
+            vector<unsigned long long> old;
+            old.swap(slots);
+            int bits = 1;
+            while ((size_t(1) << bits) < capacity)
+                ++bits;
+            slots.assign(size_t(1) << bits, EMPTY);
+            shift = 64 - bits;
+            count = 0;
+            for (unsigned long long key : old) {
+                if (key != EMPTY)
+                    insert(key);
+            }
+        }
+
+    public:
+        /**
+         * @brief Create a set sized for an expected number of keys.
+         * @param expected The number of keys expected to be inserted.
+         */
+        explicit EdgeKeySet(size_t expected = 0) {
+            rehash(std::max<size_t>(16, expected * 2));
+        }
+
+        /**
+         * @brief Insert a key.
+         * @param key The key to insert (any value except ~0).
+         * @return True if the key was not in the set, false otherwise.
+         */
+        bool insert(unsigned long long key) {
+            if ((count + 1) * 2 > slots.size())
+                rehash(slots.size() * 2);
+            size_t mask = slots.size() - 1;
+            for (size_t i = slotOf(key);; i = (i + 1) & mask) {
+                if (slots[i] == key)
+                    return false;
+                if (slots[i] == EMPTY) {
+                    slots[i] = key;
+                    ++count;
+                    return true;
+                }
+            }
+        }
+
+        /**
+         * @brief Check if a key is in the set.
+         * @param key The key to look for.
+         * @return True if the key is in the set, false otherwise.
+         */
+        bool contains(unsigned long long key) const {
+            size_t mask = slots.size() - 1;
+            for (size_t i = slotOf(key);; i = (i + 1) & mask) {
+                if (slots[i] == key)
+                    return true;
+                if (slots[i] == EMPTY)
+                    return false;
+            }
+        }
+
+        /**
+         * @brief Get the number of keys in the set.
+         * @return The number of keys.
+         */
+        size_t size() const {
+            return count;
+        }
+};
+
+template <typename G, typename = void>
+struct HasFlatEdges : std::false_type {};
+
+template <typename G>
+struct HasFlatEdges<G, std::void_t<decltype(std::declval<const G&>().getTargets())>> : std::true_type {};
+
+/**
+ * @class OutEdgeIndex
+ * @brief Numbers the edges of a graph 0..m-1 by source, so that edges can be drawn by index.
+ * Within each source, edges are numbered in ascending target order, so the numbering depends
+ * only on the edge set and matches that of a CSRView, which is indexed in place. Any other
+ * graph gets a prefix sum over its out-degrees; its rows are either flattened and sorted once
+ * (when many edges will be drawn) or searched on demand (when few will).
+ * @tparam G The type of the graph (DiGraph or CSRView).
+ */
+template <typename G>
+class OutEdgeIndex
+{
+    private:
+        const G* graph = nullptr;
+        vector<int> ownOffsets, ownTargets;
+        const int* offsets = nullptr;
+        const int* targets = nullptr;
+        int span = 0;
+
+    public:
+        /**
+         * @brief Index the edges of a graph.
+         * @param graph The graph to index; it must outlive the index and not change while it is used.
+         * @param draws The expected number of edge lookups, or -1 if unknown or if target() is used on all edges.
+         */
+        explicit OutEdgeIndex(const G& graph, long long draws = -1) : graph(&graph), span(graph.getSpan()) {
+            if constexpr (HasFlatEdges<G>::value) {
+                offsets = graph.getOffsets().begin();
+                targets = graph.getTargets().begin();
+            }
+            else {
+                ownOffsets.assign(span + 1, 0);
+                double squares = 0;
+                for (int u = 0; u < span; ++u) {
+                    int d = graph.getOutDegree(u);
+                    ownOffsets[u + 1] = ownOffsets[u] + d;
+                    squares += static_cast<double>(d) * d;
+                }
+                offsets = ownOffsets.data();
+                long long m = ownOffsets[span];
+                // A lookup without flattening reads the whole row of its source, which holds
+                // squares / m edges on average over uniformly drawn edges.
+                if (draws >= 0 && m > 0 && draws * (squares / m) < m)
+                    return;
+                ownTargets.resize(m);
+                for (int u = 0; u < span; ++u) {
+                    int pos = ownOffsets[u];
+                    graph.forEachOutEdge(u, [&](int v, const auto&) { ownTargets[pos++] = v; });
+                    std::sort(ownTargets.begin() + ownOffsets[u], ownTargets.begin() + pos);
+                }
+                targets = ownTargets.data();
+            }
+        }
+
+        /**
+         * @brief Get the number of indexed edges.
+         * @return The number of edges.
+         */
+        int size() const {
+            return offsets ? offsets[span] : 0;
+        }
+
+        /**
+         * @brief Get the index of the first edge of a vertex.
+         * @param u The index of the vertex, in [0, getSpan()]; offset(getSpan()) is size().
+         * @return The index of the first out-edge of the vertex.
+         */
+        int offset(int u) const {
+            return offsets[u];
+        }
+
+        /**
+         * @brief Get the target of the edge with the given index.
+         * @param i The index of the edge, in [0, size()).
+         * @return The target vertex of the edge.
+         */
+        int target(int i) const {
+            return targets ? targets[i] : edge(i).second;
+        }
+
+        /**
+         * @brief Get the edge with the given index.
+         * @param i The index of the edge, in [0, size()).
+         * @return The edge as a (source, target) pair.
+         */
+        pair<int, int> edge(int i) const {
+            int u = std::upper_bound(offsets, offsets + span + 1, i) - offsets - 1;
+            if (targets)
+                return {u, targets[i]};
+            thread_local vector<int> row;
+            row.clear();
+            graph->forEachOutEdge(u, [&](int v, const auto&) { row.push_back(v); });
+            auto nth = row.begin() + (i - offsets[u]);
+            std::nth_element(row.begin(), nth, row.end());
+            return {u, *nth};
+        }
+};
+
+/**
+ * @brief The number of candidates drawn from one random stream by sampleEdges().
+ */
+const int SAMPLE_BLOCK_SIZE = 1 << 16;
+
+/**
+ * @brief Draws edges in fixed-size blocks, each block from its own random stream, on several threads.
+ * Blocks are concatenated in order and, if requested, duplicates are dropped (keeping the first
+ * occurrence) and topped up from further streams. The result depends only on the seed and the
+ * draw function, not on the number of threads.
+ * @tparam Draw The type of the draw function.
+ * @param count The number of edges to return.
+ * @param distinct Flag indicating if the returned edges must be pairwise distinct.
+ * @param seed The seed the block streams are derived from.
+ * @param threads The number of threads to use; 0 uses all hardware threads.
+ * @param draw Called as draw(rng) to produce one candidate edge; must be safe to call concurrently.
+ * @return The drawn edges.
+ */
+template <typename Draw>
+vector<pair<int, int>> sampleEdges(long long count, bool distinct, unsigned long long seed, int threads, Draw&& draw) {
+    vector<pair<int, int>> result;
+    if (count <= 0)
+        return result;
+    result.reserve(count);
+    EdgeKeySet seen(distinct ? count : 0);
+    ThreadPool pool(threads);
+    unsigned long long nextStream = 0;
+    while (static_cast<long long>(result.size()) < count) {
+        long long need = count - result.size();
+        long long candidates = nextStream == 0 || !distinct ? need : need + need / 8 + 16;
+        int blocks = (candidates + SAMPLE_BLOCK_SIZE - 1) / SAMPLE_BLOCK_SIZE;
+        vector<vector<pair<int, int>>> drawn(blocks);
+        parallelFor(pool, 0, blocks, [&](int, int b) {
+            RandomStream rng(RandomStream::derive(seed, nextStream + b));
+            long long size = std::min<long long>(SAMPLE_BLOCK_SIZE, candidates - static_cast<long long>(b) * SAMPLE_BLOCK_SIZE);
+            drawn[b].reserve(size);
+            for (long long i = 0; i < size; ++i)
+                drawn[b].push_back(draw(rng));
+        }, 1);
+        nextStream += blocks;
+        for (const auto& block : drawn) {
+            for (const auto& edge : block) {
+                if (static_cast<long long>(result.size()) == count)
+                    break;
+                if (!distinct || seen.insert(packEdge(edge.first, edge.second)))
+                    result.push_back(edge);
+            }
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Draws distinct indices in proportion to their weights, without replacement (Efraimidis-Spirakis).
+ * Every index gets the key r^(1/w) for a uniform r and the largest keys win; the result has the
+ * same distribution as repeated weighted draws that skip repeats, but costs O(n) regardless of
+ * how close count is to the number of positive weights. Keys are drawn in fixed-size blocks with
+ * their own streams, so the result depends only on the seed.
+ * @param weights The non-negative weight of each index.
+ * @param count The number of indices to draw (at most the number of positive weights).
+ * @param seed The seed the block streams are derived from.
+ * @param threads The number of threads to use; 0 uses all hardware threads.
+ * @return The drawn indices, in draw order.
+ */
+inline vector<int> sampleWeightedDistinct(const vector<double>& weights, int count, unsigned long long seed, int threads) {
+    int n = weights.size();
+    vector<pair<double, int>> keys(n);
+    ThreadPool pool(threads);
+    int blocks = (n + SAMPLE_BLOCK_SIZE - 1) / SAMPLE_BLOCK_SIZE;
+    parallelFor(pool, 0, blocks, [&](int, int b) {
+        RandomStream rng(RandomStream::derive(seed, b));
+        int last = std::min(n, (b + 1) * SAMPLE_BLOCK_SIZE);
+        for (int i = b * SAMPLE_BLOCK_SIZE; i < last; ++i) {
+            // log(r) / w orders the same way as r^(1/w) without underflowing
+            double r = 1.0 - rng.uniformReal();
+            keys[i] = {weights[i] > 0 ? std::log(r) / weights[i] : -std::numeric_limits<double>::infinity(), i};
+        }
+    }, 1);
+    count = std::max(0, std::min(count, n));
+    auto byKey = [](const pair<double, int>& a, const pair<double, int>& b) {
+        return a.first != b.first ? a.first > b.first : a.second < b.second;
+    };
+    std::nth_element(keys.begin(), keys.begin() + count, keys.end(), byKey);
+    std::sort(keys.begin(), keys.begin() + count, byKey);
+    vector<int> result(count);
+    for (int i = 0; i < count; ++i)
+        result[i] = keys[i].second;
+    return result;
+}
@@ -0,0 +1,380 @@
+#pragma once
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include "Graph.hxx"
+#include "delta.hxx"
+#include "mmap.hxx"
+#include "sampler.hxx"
+#include "parallel.hxx"
+
+/**
+ * @struct DeltaSequenceHeader
+ * @brief The header of a delta sequence file.
+ * It is followed by the encoded batches and then by the batch index, which holds one
+ * DeltaSequenceEntry per batch and starts at indexOffset.
+ */
+struct DeltaSequenceHeader {
+    char magic[8];
+    unsigned int version;
+    unsigned int reserved;
+    unsigned long long batchCount;
+    unsigned long long indexOffset;
+};
+
+/**
+ * @struct DeltaSequenceEntry
+ * @brief The location and size of one batch in a delta sequence file.
+ */
+struct DeltaSequenceEntry {
+    unsigned long long offset;
+    unsigned long long length;
+    unsigned int insertions;
+    unsigned int deletions;
+};
+
+const char DELTA_SEQUENCE_MAGIC[8] = {'N', 'G', 'D', 'S', 'E', 'Q', '\0', '\0'};
+const unsigned int DELTA_SEQUENCE_VERSION = 1;
+
+/**
+ * @brief Appends an unsigned LEB128 varint to a buffer.
+ * @param out The buffer to append to.
+ * @param value The value to encode.
+ */
+inline void writeVarint(vector<unsigned char>& out, unsigned long long value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<unsigned char>(value) | 0x80);
+        value >>= 7;
+    }
+    out.push_back(static_cast<unsigned char>(value));
+}
+
+/**
+ * @brief Reads an unsigned LEB128 varint.
+ * @param p The current position, advanced past the varint.
+ * @param end The end of the buffer.
+ * @param value Set to the decoded value.
+ * @return True if a complete varint was read, false otherwise.
+ */
+inline bool readVarint(const unsigned char*& p, const unsigned char* end, unsigned long long& value) {
+    value = 0;
+    for (int shift = 0; p < end && shift < 64; shift += 7) {
+        unsigned char byte = *p++;
+        value |= static_cast<unsigned long long>(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Appends a sorted, delta-encoded edge list to a buffer.
+ * Each edge stores the gap to the previous source and then either the gap to the previous
+ * target (same source) or the target itself (new source).
+ * @param out The buffer to append to.
+ * @param edges The edges to encode; they are sorted in place.
+ */
+inline void encodeEdgeList(vector<unsigned char>& out, vector<pair<int, int>>& edges) {
+    std::sort(edges.begin(), edges.end());
+    long long prevU = 0, prevV = 0;
+    for (const auto& edge : edges) {
+        writeVarint(out, edge.first - prevU);
+        writeVarint(out, edge.first == prevU ? edge.second - prevV : edge.second);
+        prevU = edge.first;
+        prevV = edge.second;
+    }
+}
+
+/**
+ * @brief Decodes an edge list written by encodeEdgeList().
+ * @param p The current position, advanced past the list.
+ * @param end The end of the buffer.
+ * @param count The number of edges in the list.
+ * @param edges Set to the decoded edges.
+ * @return True if the list was complete, false otherwise.
+ */
+inline bool decodeEdgeList(const unsigned char*& p, const unsigned char* end, unsigned int count, vector<pair<int, int>>& edges) {
+    // Every edge takes at least two bytes, so a larger count is corrupt and must not be allocated.
+    if (count > static_cast<unsigned long long>(end - p) / 2)
+        return false;
+    edges.resize(count);
+    unsigned long long u = 0, v = 0;
+    for (unsigned int i = 0; i < count; ++i) {
+        unsigned long long du, dv;
+        if (!readVarint(p, end, du) || !readVarint(p, end, dv))
+            return false;
+        v = du == 0 ? v + dv : dv;
+        u += du;
+        edges[i] = {static_cast<int>(u), static_cast<int>(v)};
+    }
+    return true;
+}
+
+/**
+ * @class DeltaSequenceWriter
+ * @brief Writes a sequence of deltas to a compact binary file.
+ * Each batch stores its insertions and deletions as sorted, delta-encoded varint lists;
+ * edge data is not stored. The batch index is written when the file is closed.
+ */
+class DeltaSequenceWriter
+{
+    private:
+        std::ofstream file;
+        std::string fileName;
+        vector<DeltaSequenceEntry> index;
+        unsigned long long position = 0;
+        vector<unsigned char> buffer;
+
+    public:
+        DeltaSequenceWriter() = default;
+
+        /**
+         * @brief Create a sequence file.
+         * @param fileName The name of the file to write.
+         */
+        explicit DeltaSequenceWriter(const std::string& fileName) {
+            open(fileName);
+        }
+
+        ~DeltaSequenceWriter() {
+            close();
+        }
+
+        /**
+         * @brief Create a sequence file, closing any file currently open.
+         * @param fileName The name of the file to write.
+         * @return True if the file was created, false otherwise.
+         */
+        bool open(const std::string& fileName) {
+            close();
+            this->fileName = fileName;
+            file.open(fileName, std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) {
+                std::cerr << "Failed to open file: " << fileName << std::endl;
+                return false;
+            }
+            DeltaSequenceHeader header = {};
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            position = sizeof(header);
+            index.clear();
+            return static_cast<bool>(file);
+        }
+
+        /**
+         * @brief Check if a file is open for writing.
+         * @return True if batches can be written, false otherwise.
+         */
+        bool isOpen() const {
+            return file.is_open();
+        }
+
+        /**
+         * @brief Get the number of batches written so far.
+         * @return The number of batches.
+         */
+        int size() const {
+            return index.size();
+        }
+
+        /**
+         * @brief Append the insertions and deletions of a delta as the next batch.
+         * @tparam V The type of the vertices in the graph.
+         * @tparam E The type of the edges in the graph.
+         * @param delta The delta to write.
+         * @return True if the batch was written, false otherwise.
+         */
+        template <typename V, typename E>
+        bool write(const GraphDelta<V, E>& delta) {
+            if (!file.is_open())
+                return false;
+            vector<pair<int, int>> edges;
+            buffer.clear();
+            edges = delta.insertions;
+            encodeEdgeList(buffer, edges);
+            edges = delta.deletions;
+            encodeEdgeList(buffer, edges);
+            DeltaSequenceEntry entry = {position, buffer.size(), static_cast<unsigned int>(delta.insertions.size()), static_cast<unsigned int>(delta.deletions.size())};
+            file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+            position += buffer.size();
+            index.push_back(entry);
+            return static_cast<bool>(file);
+        }
+
+        /**
+         * @brief Write the batch index and header, and close the file.
+         * @return True if the file was completed, false otherwise.
+         */
+        bool close() {
+            if (!file.is_open())
+                return false;
+            DeltaSequenceHeader header = {};
+            memcpy(header.magic, DELTA_SEQUENCE_MAGIC, sizeof(header.magic));
+            header.version = DELTA_SEQUENCE_VERSION;
+            const char zeros[8] = {};
+            size_t padding = (8 - position % 8) % 8;
+            file.write(zeros, padding);
+            position += padding;
+            header.batchCount = index.size();
+            header.indexOffset = position;
+            file.write(reinterpret_cast<const char*>(index.data()), index.size() * sizeof(DeltaSequenceEntry));
+            file.seekp(0);
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            bool ok = static_cast<bool>(file);
+            file.close();
+            if (!ok)
+                std::cerr << "Failed to write file: " << fileName << std::endl;
+            return ok;
+        }
+};
+
+/**
+ * @class DeltaSequenceReader
+ * @brief Reads batches from a delta sequence file through a memory mapping, in any order.
+ */
+class DeltaSequenceReader
+{
+    private:
+        MappedFile file;
+        const DeltaSequenceEntry* index = nullptr;
+        unsigned long long batchCount = 0;
+
+    public:
+        DeltaSequenceReader() = default;
+
+        /**
+         * @brief Open a sequence file.
+         * @param fileName The name of the file to read.
+         */
+        explicit DeltaSequenceReader(const std::string& fileName) {
+            open(fileName);
+        }
+
+        /**
+         * @brief Open a sequence file, closing any file currently open.
+         * @param fileName The name of the file to read.
+         * @return True if the file is a complete delta sequence, false otherwise.
+         */
+        bool open(const std::string& fileName) {
+            index = nullptr;
+            batchCount = 0;
+            if (!file.open(fileName) || file.size() < sizeof(DeltaSequenceHeader)) {
+                std::cerr << "Failed to open file: " << fileName << std::endl;
+                return false;
+            }
+            DeltaSequenceHeader header;
+            memcpy(&header, file.data(), sizeof(header));
+            if (memcmp(header.magic, DELTA_SEQUENCE_MAGIC, sizeof(header.magic)) != 0 || header.version != DELTA_SEQUENCE_VERSION ||
+                header.indexOffset % alignof(DeltaSequenceEntry) != 0 || header.indexOffset > file.size() ||
+                header.batchCount > (file.size() - header.indexOffset) / sizeof(DeltaSequenceEntry)) {
+                std::cerr << "Invalid delta sequence: " << fileName << std::endl;
+                file.close();
+                return false;
+            }
+            index = reinterpret_cast<const DeltaSequenceEntry*>(file.data() + header.indexOffset);
+            batchCount = header.batchCount;
+            return true;
+        }
+
+        /**
+         * @brief Get the number of batches in the file.
+         * @return The number of batches.
+         */
+        int size() const {
+            return batchCount;
+        }
+
+        /**
+         * @brief Decode a batch into a delta, replacing its insertions and deletions.
+         * Edges come back sorted by (source, target).
+         * @tparam V The type of the vertices in the graph.
+         * @tparam E The type of the edges in the graph.
+         * @param k The index of the batch.
+         * @param delta The delta to fill.
+         * @return True if the batch was decoded, false otherwise.
+         */
+        template <typename V, typename E>
+        bool read(int k, GraphDelta<V, E>& delta) const {
+            delta.clearDelta();
+            if (k < 0 || static_cast<unsigned long long>(k) >= batchCount)
+                return false;
+            const DeltaSequenceEntry& entry = index[k];
+            // Every edge takes at least two bytes, which bounds the counts of an intact entry.
+            if (entry.offset > file.size() || entry.length > file.size() - entry.offset ||
+                static_cast<unsigned long long>(entry.insertions) + entry.deletions > entry.length / 2)
+                return false;
+            const unsigned char* p = reinterpret_cast<const unsigned char*>(file.data()) + entry.offset;
+            const unsigned char* end = p + entry.length;
+            return decodeEdgeList(p, end, entry.insertions, delta.insertions) &&
+                   decodeEdgeList(p, end, entry.deletions, delta.deletions);
+        }
+};
+
+/**
+ * @brief Generates an evolving sequence of deltas and streams it to a sequence file.
+ * Batch k is generated by the policy against the graph after batches 0..k-1 have been applied,
+ * then applied to the graph. A writer thread encodes and writes batch k while batch k+1 is being
+ * generated. Batch k uses the seed derived from (seed, k), so the sequence is reproducible.
+ * @tparam V The type of the vertices in the graph.
+ * @tparam E The type of the edges in the graph.
+ * @tparam Policy The type of the policy.
+ * @param graph The initial graph; it is left in the state after the last batch.
+ * @param batches The number of batches to generate.
+ * @param policy Called as policy(graph, delta) to fill each batch, e.g. with generateMixedDelta().
+ * @param fileName The name of the sequence file to write.
+ * @param seed The seed the batch seeds are derived from.
+ * @param threads The number of threads used to generate and apply each batch; 0 uses all hardware threads.
+ * @return True if every batch was written, false otherwise.
+ */
+template <typename V, typename E, typename Policy, typename A>
+bool generateDeltaSequence(DiGraph<V, E, A>& graph, int batches, Policy&& policy, const std::string& fileName, unsigned long long seed = DEFAULT_SEED, int threads = 1) {
+    DeltaSequenceWriter writer(fileName);
+    if (!writer.isOpen())
+        return false;
+    ThreadPool pool(threads);
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<GraphDelta<V, E>> queue;
+    const size_t capacity = 2;
+    bool finished = false, ok = true;
+
+    std::thread consumer([&]() {
+        while (true) {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [&]() { return finished || !queue.empty(); });
+            if (queue.empty())
+                break;
+            GraphDelta<V, E> delta = std::move(queue.front());
+            queue.pop_front();
+            changed.notify_all();
+            lock.unlock();
+            bool written = writer.write(delta);
+            lock.lock();
+            ok = ok && written;
+        }
+    });
+
+    for (int k = 0; k < batches; ++k) {
+        GraphDelta<V, E> delta(RandomStream::derive(seed, k), threads);
+        policy(static_cast<const DiGraph<V, E, A>&>(graph), delta);
+        delta.applyBatch(graph, pool);
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [&]() { return queue.size() < capacity; });
+        queue.push_back(std::move(delta));
+        changed.notify_all();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        finished = true;
+    }
+    changed.notify_all();
+    consumer.join();
+    return writer.close() && ok;
+}
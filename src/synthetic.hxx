@@ -0,0 +1,78 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include "Graph.hxx"
+#include "sampler.hxx"
+#include "parallel.hxx"
+
+/**
+ * @brief Generates an R-MAT graph (Chakrabarti et al.).
+ * Each edge picks one quadrant of the adjacency matrix per bit of the vertex index, with
+ * probabilities a, b, c and 1 - a - b - c. Duplicate edges are dropped, so the graph may
+ * have slightly fewer than edgeFactor * 2^scale edges.
+ * @tparam A The adjacency policy of the graph.
+ * @param scale The base-2 logarithm of the number of vertices.
+ * @param edgeFactor The number of edges drawn per vertex.
+ * @param a The probability of the top-left quadrant.
+ * @param b The probability of the top-right quadrant.
+ * @param c The probability of the bottom-left quadrant.
+ * @param seed The seed of the random streams.
+ * @param threads The number of threads to use; 0 uses all hardware threads.
+ * @return The generated graph, with vertex data equal to the vertex index.
+ */
+template <typename A = HashPolicy>
+DiGraph<int, int, A> generateRmatGraph(int scale, int edgeFactor, double a = 0.57, double b = 0.19, double c = 0.19, unsigned long long seed = DEFAULT_SEED, int threads = 0) {
+    DiGraph<int, int, A> graph;
+    int n = 1 << scale;
+    for (int i = 0; i < n; ++i)
+        graph.addVertex(i);
+    long long m = static_cast<long long>(edgeFactor) * n;
+    auto edges = sampleEdges(m, false, seed, threads, [&](RandomStream& rng) {
+        int u = 0, v = 0;
+        for (int bit = 0; bit < scale; ++bit) {
+            double r = rng.uniformReal();
+            int down = r >= a + b;
+            int right = (r >= a && r < a + b) || r >= a + b + c;
+            u = (u << 1) | down;
+            v = (v << 1) | right;
+        }
+        return std::make_pair(u, v);
+    });
+    ThreadPool pool(threads);
+    graph.addEdges(edges, vector<int>(), pool);
+    return graph;
+}
+
+/**
+ * @brief Generates a directed Chung-Lu graph with a power-law degree distribution.
+ * Vertex i gets the weight (i + 1)^(-1 / (exponent - 1)), and both endpoints of each edge are
+ * drawn in proportion to their weights. Duplicate edges are dropped.
+ * @tparam A The adjacency policy of the graph.
+ * @param numVertices The number of vertices.
+ * @param numEdges The number of edges drawn.
+ * @param exponent The exponent of the degree distribution (greater than 1, typically 2 to 3).
+ * @param seed The seed of the random streams.
+ * @param threads The number of threads to use; 0 uses all hardware threads.
+ * @return The generated graph, with vertex data equal to the vertex index.
+ */
+template <typename A = HashPolicy>
+DiGraph<int, int, A> generatePowerLawGraph(int numVertices, long long numEdges, double exponent = 2.1, unsigned long long seed = DEFAULT_SEED, int threads = 0) {
+    DiGraph<int, int, A> graph;
+    vector<double> weights(numVertices);
+    for (int i = 0; i < numVertices; ++i) {
+        graph.addVertex(i);
+        weights[i] = std::pow(i + 1.0, -1.0 / (exponent - 1.0));
+    }
+    if (numVertices == 0)
+        return graph;
+    AliasTable vertexDist(weights);
+    auto edges = sampleEdges(numEdges, false, seed, threads, [&](RandomStream& rng) {
+        int u = vertexDist.sample(rng);
+        int v = vertexDist.sample(rng);
+        return std::make_pair(u, v);
+    });
+    ThreadPool pool(threads);
+    graph.addEdges(edges, vector<int>(), pool);
+    return graph;
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include <chrono>
+#include <functional>
 
 /**
  * @brief Measures the time taken by a function to execute.
@@ -16,3 +17,19 @@ auto measureTime(Function&& func, Args&&... args) {
     auto end = std::chrono::high_resolution_clock::now();
     return std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
 }
+
+/**
+ * @brief Measures the time taken by a function to execute, with nanosecond resolution.
+ * @tparam Function The type of the function to measure the time of.
+ * @tparam Args The types of the arguments to the function.
+ * @param func The function to measure the time of.
+ * @param args The arguments to the function.
+ * @return The time taken by the function to execute in nanoseconds.
+ */
+template<typename Function, typename... Args>
+long long measureTimeNs(Function&& func, Args&&... args) {
+    auto start = std::chrono::steady_clock::now();
+    std::invoke(std::forward<Function>(func), std::forward<Args>(args)...);
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+}
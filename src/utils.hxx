@@ -13,6 +13,6 @@ struct PairHash {
     size_t operator()(const std::pair<T1, T2>& pair) const {
         size_t hash1 = std::hash<T1>{}(pair.first);
         size_t hash2 = std::hash<T2>{}(pair.second);
-        return hash1 ^ hash2;
+        return hash1 ^ (hash2 + 0x9e3779b97f4a7c15ULL + (hash1 << 6) + (hash1 >> 2));
     }
 };
@@ -0,0 +1,144 @@
+#include <algorithm>
+#include <map>
+#include <random>
+#include "../src/main.hxx"
+
+using namespace std;
+
+int makeValue(int, int value) {
+    return value;
+}
+
+NoData makeValue(NoData, int) {
+    return NoData();
+}
+
+int valueOf(int value) {
+    return value;
+}
+
+int valueOf(NoData) {
+    return 0;
+}
+
+/**
+ * @brief Compares the whole contents of an adjacency container with a reference map.
+ * Rows of ordered policies must also be visited in ascending key order.
+ * @return True if they match, false otherwise.
+ */
+template <typename Policy, typename Map>
+bool sameContents(const Map& row, const map<int, int>& expected) {
+    if (row.size() != expected.size() || row.empty() != expected.empty())
+        return false;
+    vector<pair<int, int>> entries, keys;
+    row.forEach([&](int key, const auto& value) { entries.push_back({key, valueOf(value)}); });
+    row.forEachKey([&](int key) { keys.push_back({key, 0}); });
+    if (!Policy::ORDERED) {
+        sort(entries.begin(), entries.end());
+        sort(keys.begin(), keys.end());
+    }
+    if (entries.size() != expected.size() || keys.size() != expected.size())
+        return false;
+    size_t i = 0;
+    for (const auto& entry : expected) {
+        if (entries[i].first != entry.first || entries[i].second != entry.second || keys[i].first != entry.first)
+            return false;
+        ++i;
+    }
+    return true;
+}
+
+/**
+ * @brief Applies random inserts, erases and lookups to one container and a reference map.
+ * Every few rounds the row is emptied key by key (which makes some containers release their
+ * storage) and then reused, and keys are drawn from a narrow or a wide range in turns.
+ * @tparam Policy The adjacency policy to test.
+ * @tparam T The value type of the container (int or NoData).
+ * @return True if every result matched the reference, false otherwise.
+ */
+template <typename Policy, typename T>
+bool testContainer(unsigned seed) {
+    typename Policy::template Map<T> row;
+    map<int, int> expected;
+    mt19937 rng(seed);
+    bool hasValues = !is_same<T, NoData>::value;
+
+    for (int round = 0; round < 40; ++round) {
+        int range = round % 2 ? 1000000 : 64;
+        int operations = 50 + rng() % 400;
+        if (round % 5 == 4)
+            row.reserve(rng() % 200);
+        for (int op = 0; op < operations; ++op) {
+            int key = rng() % range, value = hasValues ? static_cast<int>(rng() % 1000) : 0;
+            unsigned choice = rng() % 10;
+            if (choice < 5) {
+                bool inserted = row.insert(key, makeValue(T(), value));
+                if (inserted != expected.emplace(key, value).second)
+                    return false;
+            } else if (choice < 8) {
+                T erasedValue{};
+                bool erased = row.erase(key, &erasedValue);
+                auto it = expected.find(key);
+                if (erased != (it != expected.end()) || (erased && valueOf(erasedValue) != it->second))
+                    return false;
+                if (erased)
+                    expected.erase(it);
+            } else {
+                const auto& constRow = row;
+                const T* found = constRow.find(key);
+                auto it = expected.find(key);
+                if ((found != nullptr) != (it != expected.end()) || row.contains(key) != (found != nullptr) ||
+                    (found && valueOf(*found) != it->second))
+                    return false;
+            }
+        }
+        if (!sameContents<Policy>(row, expected))
+            return false;
+
+        // Empty the row completely, then check it is usable again.
+        if (round % 3 == 2) {
+            vector<int> keys;
+            for (const auto& entry : expected)
+                keys.push_back(entry.first);
+            shuffle(keys.begin(), keys.end(), rng);
+            for (int key : keys) {
+                if (!row.erase(key))
+                    return false;
+            }
+            expected.clear();
+            if (!row.empty() || row.size() != 0 || row.contains(keys.empty() ? 0 : keys[0]) || row.erase(0))
+                return false;
+            if (!sameContents<Policy>(row, expected))
+                return false;
+        }
+    }
+    row.clear();
+    expected.clear();
+    return sameContents<Policy>(row, expected) && row.insert(7) && row.contains(7) && row.size() == 1;
+}
+
+template <typename Policy>
+int testPolicy(const string& name) {
+    int failures = 0;
+    for (unsigned seed = 1; seed <= 20; ++seed) {
+        if (!testContainer<Policy, int>(seed)) {
+            cerr << "FAIL " << name << "<int>: seed " << seed << endl;
+            failures++;
+        }
+        if (!testContainer<Policy, NoData>(seed)) {
+            cerr << "FAIL " << name << "<NoData>: seed " << seed << endl;
+            failures++;
+        }
+    }
+    cout << (failures ? "FAIL " : "ok   ") << "adjacency " << name << endl;
+    return failures;
+}
+
+int main() {
+    int failures = 0;
+    failures += testPolicy<HashPolicy>("HashAdjacency");
+    failures += testPolicy<SortedVectorPolicy>("SortedVectorAdjacency");
+    failures += testPolicy<FlatHashPolicy>("FlatHashAdjacency");
+    failures += testPolicy<AVLPolicy>("AVLTree");
+    return failures ? 1 : 0;
+}
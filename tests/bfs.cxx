@@ -0,0 +1,116 @@
+#include "../src/main.hxx"
+
+using namespace std;
+
+/**
+ * @brief Derives per-vertex levels from the visit order of the reference breadth-first search.
+ * Each vertex is one level below the first vertex in the order that reaches it.
+ * @param graph The graph that was searched.
+ * @param order The visit order returned by breadthFirstSearch().
+ * @return The level of each vertex, or -1 if it was not reached.
+ */
+template <typename G>
+vector<int> referenceLevels(const G& graph, const vector<int>& order) {
+    vector<int> level(graph.getSpan(), -1);
+    if (order.empty())
+        return level;
+    level[order[0]] = 0;
+    for (int u : order) {
+        graph.forEachOutEdge(u, [&](int v, const auto&) {
+            if (level[v] == -1)
+                level[v] = level[u] + 1;
+        });
+    }
+    return level;
+}
+
+/**
+ * @brief Compares a parallel search with the reference levels.
+ * Levels must match exactly, the order must hold every reached vertex once by non-decreasing
+ * level, and every parent must be an in-neighbour one level up. Mismatches are reported on std::cerr.
+ * @return True if the search is correct, false otherwise.
+ */
+template <typename V, typename E, typename A>
+bool checkSearch(const DiGraph<V, E, A>& graph, int start, const vector<int>& expected, const BFSResult& result) {
+    int n = graph.getSpan(), reached = 0;
+    for (int v = 0; v < n; ++v) {
+        if (result.level[v] != expected[v]) {
+            cerr << "vertex " << v << ": level " << result.level[v] << ", expected " << expected[v] << endl;
+            return false;
+        }
+        if (expected[v] < 0)
+            continue;
+        reached++;
+        int p = result.parent[v];
+        bool validParent = v == start ? p == start : p >= 0 && graph.hasEdge(p, v) && expected[p] + 1 == expected[v];
+        if (!validParent) {
+            cerr << "vertex " << v << ": invalid parent " << p << endl;
+            return false;
+        }
+    }
+    if (static_cast<int>(result.order.size()) != reached) {
+        cerr << "order holds " << result.order.size() << " vertices, expected " << reached << endl;
+        return false;
+    }
+    for (size_t i = 1; i < result.order.size(); ++i) {
+        if (expected[result.order[i]] < expected[result.order[i - 1]]) {
+            cerr << "order is not by level at position " << i << endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Runs the parallel search on one graph from a few starts, on 1, 2 and all hardware
+ * threads, with and without incoming edges in the snapshot. Without them every level is
+ * expanded top-down; with them the default thresholds switch between directions, and the
+ * forced thresholds expand every level after the first bottom-up.
+ * @return The number of failed cases.
+ */
+template <typename V, typename E, typename A>
+int testGraph(const string& name, const DiGraph<V, E, A>& graph) {
+    int failures = 0;
+    int n = graph.getSpan(), hub = 0;
+    for (int u = 0; u < n; ++u) {
+        if (graph.getOutDegree(u) > graph.getOutDegree(hub))
+            hub = u;
+    }
+    vector<int> starts = {0, hub, n / 2, n - 1};
+    ThreadPool single(1), dual(2), all(0);
+    ThreadPool* pools[] = {&single, &dual, &all};
+    CSRView<V, E> outOnly(graph, false), withIn(graph, true);
+
+    for (int start : starts) {
+        vector<int> expected = referenceLevels(graph, breadthFirstSearch(graph, start));
+        for (ThreadPool* pool : pools) {
+            struct { const char* mode; const CSRView<V, E>* csr; double alpha, beta; } cases[] = {
+                {"top-down", &outOnly, 15, 18},
+                {"direction-optimizing", &withIn, 15, 18},
+                {"bottom-up", &withIn, 1e9, 1e9},
+            };
+            for (const auto& c : cases) {
+                BFSResult result = parallelBreadthFirstSearch(*c.csr, start, *pool, c.alpha, c.beta);
+                if (!checkSearch(graph, start, expected, result)) {
+                    cerr << "FAIL " << name << ": start " << start << ", " << pool->size() << " threads, " << c.mode << endl;
+                    failures++;
+                }
+            }
+        }
+    }
+    cout << (failures ? "FAIL " : "ok   ") << name << endl;
+    return failures;
+}
+
+int main() {
+    int failures = 0;
+    failures += testGraph("bfs G54", loadMtxGraphFromFile<int, int>("samples/G54.mtx"));
+
+    auto rmat = generateRmatGraph(12, 8);
+    failures += testGraph("bfs rmat-12-8", rmat);
+    // Vertices missing from the snapshot must be skipped by both directions.
+    for (int u = 1; u < rmat.getSpan(); u += 97)
+        rmat.removeVertex(u);
+    failures += testGraph("bfs rmat-12-8 with removed vertices", rmat);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,143 @@
+#include <algorithm>
+#include <cstdio>
+#include "../src/main.hxx"
+
+using namespace std;
+
+const char* SEQUENCE_FILE = "tests/sequence.tmp";
+
+/**
+ * @brief Gets the edges of a graph in sorted order, for comparing graphs built in different ways.
+ */
+template <typename V, typename E, typename A>
+vector<pair<int, int>> sortedEdges(const DiGraph<V, E, A>& graph) {
+    vector<pair<int, int>> edges = graph.getAllEdges();
+    sort(edges.begin(), edges.end());
+    return edges;
+}
+
+/**
+ * @brief Checks that a batch read back from a sequence holds the edges of the delta that was written.
+ * Batches come back sorted by (source, target), so the written lists are sorted before comparing.
+ */
+bool sameBatch(const GraphDelta<int, int>& written, const GraphDelta<int, int>& read) {
+    vector<pair<int, int>> insertions = written.insertions, deletions = written.deletions;
+    sort(insertions.begin(), insertions.end());
+    sort(deletions.begin(), deletions.end());
+    return insertions == read.insertions && deletions == read.deletions;
+}
+
+/**
+ * @brief Generates a sequence against an evolving graph, reads every batch back (in reverse, to
+ * exercise random access) and replays the batches on a copy of the initial graph.
+ * @return True if the batches and the replayed graph match, false otherwise.
+ */
+bool testGeneratedSequence() {
+    auto graph = generateRmatGraph(10, 8);
+    auto initial = graph;
+    vector<GraphDelta<int, int>> written;
+    bool generated = generateDeltaSequence(graph, 12, [&](const DiGraph<int, int>& current, GraphDelta<int, int>& delta) {
+        delta.generateMixedDelta(current, 0.5, 400, true);
+        written.push_back(delta);
+    }, SEQUENCE_FILE, DEFAULT_SEED, 2);
+    DeltaSequenceReader reader(SEQUENCE_FILE);
+    if (!generated || reader.size() != static_cast<int>(written.size()))
+        return false;
+    vector<GraphDelta<int, int>> batches(reader.size());
+    for (int k = reader.size() - 1; k >= 0; --k) {
+        if (!reader.read(k, batches[k]) || !sameBatch(written[k], batches[k]))
+            return false;
+    }
+    for (auto& batch : batches)
+        batch.applyBatch(initial, 1);
+    return sortedEdges(initial) == sortedEdges(graph);
+}
+
+/**
+ * @brief Writes batches by hand, including an empty one, duplicates and vertex indices whose
+ * varints take several bytes, and reads them back.
+ * @return True if every batch comes back unchanged, false otherwise.
+ */
+bool testWrittenBatches() {
+    vector<GraphDelta<int, int>> written(3);
+    written[1].insertions = {{5, 3}, {0, 0}, {INT_MAX - 1, 1 << 20}, {5, 3}, {5, 200000}};
+    written[1].deletions = {{1 << 30, 7}, {1 << 30, 2}};
+    written[2].deletions = {{2, 1}};
+    {
+        DeltaSequenceWriter writer(SEQUENCE_FILE);
+        for (const auto& delta : written) {
+            if (!writer.write(delta))
+                return false;
+        }
+        if (!writer.close())
+            return false;
+    }
+    DeltaSequenceReader reader(SEQUENCE_FILE);
+    GraphDelta<int, int> batch;
+    if (reader.size() != 3 || reader.read(3, batch) || reader.read(-1, batch))
+        return false;
+    for (int k = 0; k < 3; ++k) {
+        if (!reader.read(k, batch) || !sameBatch(written[k], batch))
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Corrupts the edge counts of one index entry and truncates the file.
+ * The corrupt batch must be rejected without allocating for the bogus count, the other batches
+ * must stay readable, and a truncated file must not open.
+ * @return True if the corruption is detected, false otherwise.
+ */
+bool testCorruptSequence() {
+    GraphDelta<int, int> delta;
+    delta.insertions = {{1, 2}, {3, 4}};
+    {
+        DeltaSequenceWriter writer(SEQUENCE_FILE);
+        writer.write(delta);
+        writer.write(delta);
+    }
+    string contents;
+    {
+        ifstream in(SEQUENCE_FILE, ios::binary);
+        contents.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+    }
+    DeltaSequenceHeader header;
+    memcpy(&header, contents.data(), sizeof(header));
+    DeltaSequenceEntry entry;
+    memcpy(&entry, contents.data() + header.indexOffset, sizeof(entry));
+    entry.insertions = 0xffffffffu;
+    memcpy(&contents[header.indexOffset], &entry, sizeof(entry));
+    {
+        ofstream out(SEQUENCE_FILE, ios::binary | ios::trunc);
+        out << contents;
+    }
+    DeltaSequenceReader reader(SEQUENCE_FILE);
+    GraphDelta<int, int> batch;
+    if (reader.size() != 2 || reader.read(0, batch) || !batch.insertions.empty() || !reader.read(1, batch) || batch.insertions != delta.insertions)
+        return false;
+
+    {
+        ofstream out(SEQUENCE_FILE, ios::binary | ios::trunc);
+        out << contents.substr(0, contents.size() - 8);
+    }
+    cerr << "(an invalid delta sequence error is expected)" << endl;
+    DeltaSequenceReader truncated;
+    return !truncated.open(SEQUENCE_FILE);
+}
+
+int main() {
+    int failures = 0;
+    struct { const char* name; bool (*run)(); } tests[] = {
+        {"sequence generated round trip", testGeneratedSequence},
+        {"sequence written batches", testWrittenBatches},
+        {"sequence corrupt entries", testCorruptSequence},
+    };
+    for (const auto& test : tests) {
+        bool ok = test.run();
+        cout << (ok ? "ok   " : "FAIL ") << test.name << endl;
+        failures += !ok;
+    }
+    remove(SEQUENCE_FILE);
+    return failures ? 1 : 0;
+}